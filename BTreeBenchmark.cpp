@@ -7,6 +7,10 @@
 #include <random>
 #include <optional>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <thread>
 
 #include "Tuple.hpp"
 #include "SimpleBPlusTree.hpp"
@@ -14,6 +18,7 @@
 #include "LeafNode.hpp"
 #include "AppendOnlyLeafNode.hpp"
 #include "LasTree.hpp"
+#include "ShardedLasTree.hpp"
 
 constexpr size_t POOL_SIZE = 64;
 constexpr size_t PAGE_SIZE = 4096;
@@ -521,10 +526,491 @@ void run_benchmark(size_t dataSize) {
     std::cout << "CSV written to btree_benchmark.csv\n";
 }
 
+// ===================== concurrent benchmark mode =====================
+
+// HDR-style latency histogram: power-of-two value ranges split into 32
+// linear sub-buckets, so relative error stays ~3% across the whole ns
+// range while record() is two shifts and an increment. Each thread keeps
+// its own histogram and they are merged after the run — no atomics on
+// the hot path.
+class LatencyHistogram {
+    static constexpr size_t SUB = 32;
+    static constexpr size_t BUCKETS = 60 * SUB;
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+
+    static size_t index_of(uint64_t v) {
+        if (v < SUB) return v;
+        size_t exp = std::bit_width(v) - 1; // >= 5 here
+        size_t sub = (v >> (exp - 5)) & (SUB - 1);
+        return std::min(BUCKETS - 1, (exp - 4) * SUB + sub);
+    }
+
+    static uint64_t value_of(size_t idx) {
+        if (idx < SUB) return idx;
+        size_t exp = idx / SUB + 4;
+        uint64_t sub = idx % SUB;
+        return (SUB + sub) << (exp - 5);
+    }
+
+public:
+    void record(uint64_t ns) {
+        ++counts[index_of(ns)];
+        ++total;
+    }
+
+    void merge(const LatencyHistogram &other) {
+        for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+        total += other.total;
+    }
+
+    uint64_t count() const { return total; }
+
+    // quantile in [0,1]; returns microseconds
+    double percentile(double q) const {
+        if (total == 0) return 0.0;
+        uint64_t target = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= target) return static_cast<double>(value_of(i)) / 1000.0;
+        }
+        return static_cast<double>(value_of(BUCKETS - 1)) / 1000.0;
+    }
+};
+
+struct ConcurrentRow {
+    std::string tree_name;
+    size_t writers;
+    size_t readers;
+    std::string op;
+    double p50, p95, p99, p999; // microseconds
+    double throughput;          // ops per second over the whole phase
+};
+
+// Drives one tree with num_writers insert threads (disjoint, mostly-sorted
+// key partitions — the workload the fast path is built for) and
+// num_readers point-lookup threads running until the writers finish.
+// Sampled throughput goes straight to tput_out; per-op latency summaries
+// are appended to rows. Finishes with a full verification pass.
+void run_concurrent_workload(db::BaseFile &tree, const std::string &label,
+                             size_t dataSize, size_t num_writers, size_t num_readers,
+                             const db::TupleDesc &td,
+                             std::vector<ConcurrentRow> &rows, std::ofstream &tput_out) {
+    using clock = std::chrono::steady_clock;
+    std::cout << "  " << label << ": " << num_writers << " writers, "
+              << num_readers << " readers, " << dataSize << " keys\n";
+
+    // Disjoint contiguous partitions, each mostly sorted with local swaps
+    // (same perturbation shape as the single-threaded mode at 0.8).
+    size_t chunk = dataSize / num_writers;
+    std::vector<std::vector<TupleT>> partitions(num_writers);
+    std::vector<double> weights;
+    for (int i = 1; i <= 200; ++i) weights.push_back(std::exp(-0.05 * i));
+    for (size_t w = 0; w < num_writers; ++w) {
+        size_t begin = w * chunk;
+        size_t end = (w + 1 == num_writers) ? dataSize : begin + chunk;
+        std::vector<key_type> part_keys(end - begin);
+        std::iota(part_keys.begin(), part_keys.end(), static_cast<key_type>(begin));
+        std::mt19937 rng(42 + w);
+        std::discrete_distribution<int> offset_dist(weights.begin(), weights.end());
+        std::uniform_int_distribution<size_t> pos_dist(0, part_keys.size() - 1);
+        size_t swap_times = part_keys.size() / 5;
+        for (size_t i = 0; i < swap_times; ++i) {
+            size_t idx1 = pos_dist(rng);
+            size_t idx2 = std::min(part_keys.size() - 1, idx1 + offset_dist(rng) + 1);
+            std::swap(part_keys[idx1], part_keys[idx2]);
+        }
+        for (key_type k: part_keys) {
+            std::vector<Field> fields = {Field(k), Field("val-" + std::to_string(k))};
+            partitions[w].emplace_back(fields, td.get_types());
+        }
+    }
+
+    std::atomic<uint64_t> insert_ops{0};
+    std::atomic<uint64_t> get_ops{0};
+    std::atomic<bool> writers_done{false};
+    std::vector<LatencyHistogram> insert_hists(num_writers);
+    std::vector<LatencyHistogram> get_hists(num_readers);
+
+    auto bench_start = clock::now();
+
+    std::vector<std::thread> writers;
+    for (size_t w = 0; w < num_writers; ++w) {
+        writers.emplace_back([&, w] {
+            for (const TupleT &t: partitions[w]) {
+                auto t0 = clock::now();
+                tree.insert(t);
+                auto t1 = clock::now();
+                insert_hists[w].record(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                insert_ops.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < num_readers; ++r) {
+        readers.emplace_back([&, r] {
+            // uniform lookups over the full keyspace; early ones may miss
+            // keys not inserted yet, which is fine — contention is the point
+            std::mt19937 rng(1000 + r);
+            std::uniform_int_distribution<key_type> dist(0, static_cast<key_type>(dataSize - 1));
+            while (!writers_done.load(std::memory_order_relaxed)) {
+                key_type k = dist(rng);
+                auto t0 = clock::now();
+                auto val = tree.get(Field(k));
+                auto t1 = clock::now();
+                (void) val;
+                get_hists[r].record(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+                get_ops.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // throughput-over-time sampler, one row per 100ms window
+    std::thread monitor([&] {
+        uint64_t last = 0;
+        while (!writers_done.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            uint64_t now_ops = insert_ops.load(std::memory_order_relaxed) +
+                               get_ops.load(std::memory_order_relaxed);
+            double elapsed = std::chrono::duration<double>(clock::now() - bench_start).count();
+            tput_out << label << "," << num_writers << "," << num_readers << ","
+                     << elapsed << "," << (now_ops - last) * 10 << "\n";
+            last = now_ops;
+        }
+    });
+
+    for (auto &t: writers) t.join();
+    double insert_wall = std::chrono::duration<double>(clock::now() - bench_start).count();
+    writers_done.store(true, std::memory_order_relaxed);
+    for (auto &t: readers) t.join();
+    monitor.join();
+    double total_wall = std::chrono::duration<double>(clock::now() - bench_start).count();
+
+    // nothing a writer inserted may be lost under contention
+    for (size_t k = 0; k < dataSize; ++k) {
+        if (!tree.get(Field(static_cast<key_type>(k))).has_value()) {
+            throw std::runtime_error(label + ": missing key after concurrent load");
+        }
+    }
+
+    LatencyHistogram insert_hist, get_hist;
+    for (const auto &h: insert_hists) insert_hist.merge(h);
+    for (const auto &h: get_hists) get_hist.merge(h);
+
+    rows.push_back({label, num_writers, num_readers, "insert",
+                    insert_hist.percentile(0.50), insert_hist.percentile(0.95),
+                    insert_hist.percentile(0.99), insert_hist.percentile(0.999),
+                    static_cast<double>(insert_hist.count()) / insert_wall});
+    if (get_hist.count() > 0) {
+        rows.push_back({label, num_writers, num_readers, "get",
+                        get_hist.percentile(0.50), get_hist.percentile(0.95),
+                        get_hist.percentile(0.99), get_hist.percentile(0.999),
+                        static_cast<double>(get_hist.count()) / total_wall});
+    }
+}
+
+void run_concurrent_benchmark(size_t dataSize, size_t num_writers, size_t num_readers) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"key", "val"});
+    std::vector<ConcurrentRow> rows;
+
+    std::ofstream tput_out("btree_concurrent_throughput.csv");
+    tput_out << "TreeType,Writers,Readers,ElapsedSec,OpsPerSec\n";
+
+    std::cout << "Concurrent benchmark:\n";
+
+    {
+        const char *name = "las_conc.db";
+        std::remove(name);
+        db::getDatabase().add(std::make_unique<LasTree<key_type, 4>>(0, name, td));
+        auto &tree = db::getDatabase().get(name);
+        tree.init();
+        run_concurrent_workload(tree, "LasTree", dataSize, num_writers, num_readers,
+                                td, rows, tput_out);
+    }
+
+    {
+        // shard boundaries match the writer partitions, so each writer
+        // stays on its own shard
+        const char *name = "sharded_conc.db";
+        std::remove(name);
+        for (size_t i = 0; i < num_writers; ++i) {
+            std::remove((std::string(name) + ".shard" + std::to_string(i)).c_str());
+        }
+        std::vector<key_type> boundaries;
+        size_t chunk = dataSize / num_writers;
+        for (size_t w = 1; w < num_writers; ++w) {
+            boundaries.push_back(static_cast<key_type>(w * chunk));
+        }
+        db::getDatabase().add(std::make_unique<ShardedLasTree<key_type, 4>>(
+            0, name, td, boundaries));
+        auto &tree = db::getDatabase().get(name);
+        tree.init();
+        run_concurrent_workload(tree, "ShardedLasTree", dataSize, num_writers, num_readers,
+                                td, rows, tput_out);
+    }
+
+    std::ofstream out("btree_concurrent_benchmark.csv");
+    out << "TreeType,Writers,Readers,Op,P50us,P95us,P99us,P999us,ThroughputOpsPerSec\n";
+    for (const auto &r: rows) {
+        out << r.tree_name << "," << r.writers << "," << r.readers << "," << r.op << ","
+            << r.p50 << "," << r.p95 << "," << r.p99 << "," << r.p999 << ","
+            << r.throughput << "\n";
+        std::cout << "  " << r.tree_name << " " << r.op
+                  << ": p50=" << r.p50 << "us p95=" << r.p95 << "us p99=" << r.p99
+                  << "us p999=" << r.p999 << "us tput=" << r.throughput << " ops/s\n";
+    }
+    std::cout << "CSV written to btree_concurrent_benchmark.csv and btree_concurrent_throughput.csv\n";
+}
+
+// ===================== trace record / replay mode =====================
+
+// Record a synthetic workload with the traffic shapes that break the fast
+// path and that the fixed 50/50 interleave above cannot express: sortedness
+// shifting mid-stream (phases 1.0 -> 0.8 -> 0.2 -> 0.95 within each
+// thread's partition), bursts separated by idle gaps, and lookups skewed
+// toward the hot tail of the insert frontier. The point is not this
+// generator — it is that the same recorder hook captures production
+// traffic, and trace-replay then drives any feature change with it.
+void run_trace_record(size_t dataSize, const std::string &trace_path, size_t num_threads) {
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"key", "val"});
+    const char *name = "las_trace_rec.db";
+    std::remove(name);
+    db::getDatabase().add(std::make_unique<LasTree<key_type, 4>>(0, name, td));
+    auto &tree = db::getDatabase().get(name);
+    tree.init();
+
+    db::TraceRecorder recorder(trace_path);
+    tree.attach_recorder(&recorder);
+
+    const std::vector<double> phases = {1.0, 0.8, 0.2, 0.95};
+    size_t chunk = dataSize / num_threads;
+    std::vector<double> weights;
+    for (int i = 1; i <= 200; ++i) weights.push_back(std::exp(-0.05 * i));
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < num_threads; ++w) {
+        workers.emplace_back([&, w] {
+            size_t begin = w * chunk;
+            size_t end = (w + 1 == num_threads) ? dataSize : begin + chunk;
+            std::vector<key_type> part_keys(end - begin);
+            std::iota(part_keys.begin(), part_keys.end(), static_cast<key_type>(begin));
+
+            // perturb each quarter of the partition at its phase's sortedness
+            std::mt19937 rng(97 + w);
+            std::discrete_distribution<int> offset_dist(weights.begin(), weights.end());
+            size_t quarter = part_keys.size() / phases.size();
+            for (size_t p = 0; p < phases.size(); ++p) {
+                size_t lo = p * quarter;
+                size_t hi = (p + 1 == phases.size()) ? part_keys.size() : lo + quarter;
+                size_t swap_times = static_cast<size_t>((hi - lo) * (1.0 - phases[p]));
+                std::uniform_int_distribution<size_t> pos_dist(lo, hi - 1);
+                for (size_t i = 0; i < swap_times; ++i) {
+                    size_t idx1 = pos_dist(rng);
+                    size_t idx2 = std::min(hi - 1, idx1 + offset_dist(rng) + 1);
+                    std::swap(part_keys[idx1], part_keys[idx2]);
+                }
+            }
+
+            std::uniform_int_distribution<size_t> hot_dist(0, 99);
+            size_t ops = 0;
+            for (size_t i = 0; i < part_keys.size(); ++i) {
+                key_type k = part_keys[i];
+                std::vector<Field> fields = {Field(k), Field("val-" + std::to_string(k))};
+                tree.insert(TupleT(fields, td.get_types()));
+
+                // ~30% lookups, skewed toward the last 5% inserted
+                if (i % 10 >= 7 && i > 20) {
+                    size_t back = std::max<size_t>(1, i / 20);
+                    size_t off = hot_dist(rng) % back;
+                    tree.get(Field(part_keys[i - 1 - off]));
+                }
+
+                // bursts of 256 ops separated by idle gaps, occasionally long
+                if (++ops % 256 == 0) {
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(ops % 1024 == 0 ? 10 : 2));
+                }
+            }
+        });
+    }
+    for (auto &t: workers) t.join();
+
+    tree.attach_recorder(nullptr);
+    recorder.flush();
+    tree.stop_background();
+    std::cout << "Trace written to " << trace_path << "\n";
+}
+
+// Replay a recorded trace against a fresh tree. Recorded thread slots are
+// mapped onto the requested number of replay threads (0 = one per recorded
+// slot), each replaying its records in timestamp order and pacing the
+// recorded inter-arrival gaps divided by `speedup` (0 = no pacing). Emits
+// the same ResultRow columns as the main benchmark plus a time series of
+// the fast-path counters, so a sortedness shift mid-trace shows up as a
+// burst of window resets at the matching offset.
+void run_trace_replay(const std::string &trace_path, double speedup, size_t num_threads) {
+    using clock = std::chrono::steady_clock;
+    std::vector<db::TraceRecord> records = db::load_trace(trace_path);
+    if (records.empty()) {
+        throw std::runtime_error("empty or unreadable trace: " + trace_path);
+    }
+
+    size_t slots = 0;
+    for (const auto &r: records) slots = std::max<size_t>(slots, r.thread + 1);
+    if (num_threads == 0) num_threads = slots;
+    std::vector<std::vector<const db::TraceRecord *>> per_thread(num_threads);
+    for (const auto &r: records) {
+        per_thread[r.thread % num_threads].push_back(&r);
+    }
+    std::cout << "Replaying " << records.size() << " ops from " << trace_path
+              << " (" << slots << " recorded threads -> " << num_threads
+              << " replay threads, speedup "
+              << (speedup > 0 ? std::to_string(speedup) : std::string("max")) << ")\n";
+
+    db::TupleDesc td({db::type_t::INT, db::type_t::CHAR}, {"key", "val"});
+    const char *name = "las_trace_rep.db";
+    std::remove(name);
+    db::getDatabase().add(std::make_unique<LasTree<key_type, 4>>(0, name, td));
+    auto &tree = db::getDatabase().get(name);
+    tree.init();
+    auto *tree_ptr = dynamic_cast<LasTree<key_type, 4> *>(&tree);
+    if (!tree_ptr) throw std::runtime_error("Failed to cast BaseFile to LasTree");
+
+    std::atomic<uint64_t> done_ops{0};
+    std::vector<LatencyHistogram> insert_hists(num_threads), get_hists(num_threads);
+    std::vector<uint64_t> insert_ns(num_threads, 0), get_ns(num_threads, 0);
+    std::atomic<bool> replay_done{false};
+
+    auto bench_start = clock::now();
+
+    // fast-path counters over time, one row per 100ms window
+    std::ofstream fp_out("btree_trace_fastpath.csv");
+    fp_out << "ElapsedSec,Ops,FastPathHits,FastPathMisses,WindowHardResets\n";
+    std::thread monitor([&] {
+        while (!replay_done.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            auto stats = tree_ptr->get_stats();
+            double elapsed = std::chrono::duration<double>(clock::now() - bench_start).count();
+            fp_out << elapsed << "," << done_ops.load(std::memory_order_relaxed) << ","
+                   << stats.fast_path_hits << "," << stats.fast_path_misses << ","
+                   << stats.window_hard_resets << "\n";
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (size_t w = 0; w < num_threads; ++w) {
+        workers.emplace_back([&, w] {
+            for (const db::TraceRecord *rec: per_thread[w]) {
+                if (speedup > 0) {
+                    auto due = bench_start + std::chrono::nanoseconds(
+                        static_cast<uint64_t>(rec->ts_ns / speedup));
+                    std::this_thread::sleep_until(due);
+                }
+                key_type k = static_cast<key_type>(rec->key);
+                auto t0 = clock::now();
+                switch (static_cast<db::TraceOp>(rec->op)) {
+                    case db::TraceOp::INSERT: {
+                        std::vector<Field> fields = {Field(k), Field("val-" + std::to_string(k))};
+                        tree.insert(TupleT(fields, td.get_types()));
+                        auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            clock::now() - t0).count();
+                        insert_hists[w].record(dt);
+                        insert_ns[w] += dt;
+                        break;
+                    }
+                    case db::TraceOp::UPDATE: {
+                        std::vector<Field> fields = {Field(k), Field("val-" + std::to_string(k))};
+                        tree.update(TupleT(fields, td.get_types()));
+                        auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            clock::now() - t0).count();
+                        insert_hists[w].record(dt);
+                        insert_ns[w] += dt;
+                        break;
+                    }
+                    case db::TraceOp::GET: {
+                        auto val = tree.get(Field(k));
+                        (void) val;
+                        auto dt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            clock::now() - t0).count();
+                        get_hists[w].record(dt);
+                        get_ns[w] += dt;
+                        break;
+                    }
+                }
+                done_ops.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    for (auto &t: workers) t.join();
+    double wall_ms = std::chrono::duration<double, std::milli>(clock::now() - bench_start).count();
+    replay_done.store(true);
+    monitor.join();
+
+    LatencyHistogram insert_hist, get_hist;
+    uint64_t insert_total_ns = 0, get_total_ns = 0;
+    for (size_t w = 0; w < num_threads; ++w) {
+        insert_hist.merge(insert_hists[w]);
+        get_hist.merge(get_hists[w]);
+        insert_total_ns += insert_ns[w];
+        get_total_ns += get_ns[w];
+    }
+
+    auto [leaf_count, utilization] = tree_ptr->get_leaf_stats();
+    auto stats = tree_ptr->get_stats();
+    double read_ratio = static_cast<double>(get_hist.count()) / records.size();
+    ResultRow row{"LasTree-replay", -1.0, read_ratio,
+                  insert_hist.count() ? insert_total_ns / 1e6 / insert_hist.count() : 0.0,
+                  get_hist.count() ? get_total_ns / 1e6 / get_hist.count() : 0.0,
+                  0.0, wall_ms / records.size(),
+                  leaf_count, utilization, stats.fast_path_hits,
+                  stats.sorted_leaf_searches};
+
+    std::ofstream out("btree_trace_replay.csv");
+    out << "TreeType,Sortedness,ReadRatio,InsertTime,PointLookupTime,RangeQueryTime,MixedWorkloadTime,LeafCount,LeafUtilization,FastPathHits,SortedLeafSearch\n";
+    out << row.tree_name << "," << row.sortedness << "," << row.read_ratio << ","
+        << row.insert_time_ms << "," << row.search_time_ms << "," << row.range_query_time_ms << ","
+        << row.mixed_workload_time_ms << "," << row.leaf_count << "," << row.leaf_utilization << ","
+        << row.fast_path_hits << "," << row.sorted_leaf_search << "\n";
+
+    std::cout << "  insert: p50=" << insert_hist.percentile(0.50)
+              << "us p99=" << insert_hist.percentile(0.99) << "us\n"
+              << "  get:    p50=" << get_hist.percentile(0.50)
+              << "us p99=" << get_hist.percentile(0.99) << "us\n"
+              << "  fast path: " << stats.fast_path_hits << " hits, "
+              << stats.fast_path_misses << " misses, "
+              << stats.window_hard_resets << " hard resets\n"
+              << "CSV written to btree_trace_replay.csv and btree_trace_fastpath.csv\n";
+    tree.stop_background();
+}
+
 int main(int argc, char *argv[]) {
     size_t dataSize = 100000;
     if (argc > 1) dataSize = std::stoi(argv[1]);
 
+    if (argc > 2 && std::string(argv[2]) == "concurrent") {
+        size_t num_writers = argc > 3 ? std::stoul(argv[3]) : 4;
+        size_t num_readers = argc > 4 ? std::stoul(argv[4]) : 2;
+        run_concurrent_benchmark(dataSize, std::max<size_t>(1, num_writers), num_readers);
+        return 0;
+    }
+
+    if (argc > 2 && std::string(argv[2]) == "trace-record") {
+        std::string path = argc > 3 ? argv[3] : "btree.trace";
+        size_t threads = argc > 4 ? std::stoul(argv[4]) : 4;
+        run_trace_record(dataSize, path, std::max<size_t>(1, threads));
+        return 0;
+    }
+
+    if (argc > 2 && std::string(argv[2]) == "trace-replay") {
+        std::string path = argc > 3 ? argv[3] : "btree.trace";
+        double speedup = argc > 4 ? std::stod(argv[4]) : 1.0;
+        size_t threads = argc > 5 ? std::stoul(argv[5]) : 0; // 0 = as recorded
+        run_trace_replay(path, speedup, threads);
+        return 0;
+    }
+
     run_benchmark(dataSize);
     return 0;
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include <random>
 #include <vector>
 #include <unordered_set>
+#include "KeySearch.hpp"
 #include "NodeTypes.hpp"
 #include "Tuple.hpp"
 
@@ -51,6 +52,8 @@ public:
     uint8_t* buffer;
     const TupleDesc& td;
     size_t key_index{};
+    size_t key_offset{};   // byte offset of the key within a serialized record
+    bool key_fixed{false}; // true when the key sits at a fixed offset
 
     BaseHeader* base_header;
     PageHeader* page_header;
@@ -66,6 +69,7 @@ public:
         base_header = reinterpret_cast<BaseHeader*>(buffer);
         page_header = reinterpret_cast<PageHeader*>(buffer + sizeof(BaseHeader));
         slots = reinterpret_cast<Slot*>(buffer + sizeof(BaseHeader) + sizeof(PageHeader));
+        init_key_offset();
     }
 
     AppendOnlyLeafNode(Page &page, const TupleDesc& desc, size_t key, node_id_type id, node_id_type next_id,  SplitPolicy policy, bool isCold)
@@ -76,6 +80,7 @@ public:
         base_header = reinterpret_cast<BaseHeader*>(buffer);
         page_header = reinterpret_cast<PageHeader*>(buffer + sizeof(BaseHeader));
         slots = reinterpret_cast<Slot*>(buffer + sizeof(BaseHeader) + sizeof(PageHeader));
+        init_key_offset();
 
         base_header->type = 0;
         page_header->id = id;
@@ -114,6 +119,35 @@ public:
         return std::get<key_type>(t.get_field(key_index));
     }
 
+    void init_key_offset() {
+        if (auto offset = td.fixed_field_offset(key_index)) {
+            key_offset = *offset;
+            key_fixed = true;
+        }
+    }
+
+    // Read the key of slot i straight out of the serialized record; only
+    // falls back to full Tuple deserialization when the key is not at a
+    // fixed offset. Callers must not pass a tombstone slot.
+    //
+    // An optimistic reader racing a writer can observe a torn slot; never
+    // chase an offset outside the page — latch validation makes the reader
+    // retry, so returning a garbage key here is harmless.
+    key_type key_at(size_t i) const {
+        const Slot &s = slots[i];
+        if (static_cast<size_t>(s.offset) + s.length > block_size) {
+            return key_type{};
+        }
+        if constexpr (std::is_arithmetic_v<key_type>) {
+            if (key_fixed) {
+                key_type k;
+                std::memcpy(&k, buffer + s.offset + sizeof(OpType) + key_offset, sizeof(key_type));
+                return k;
+            }
+        }
+        return std::get<key_type>(td.read_field(buffer + s.offset + sizeof(OpType), key_index));
+    }
+
     OpType get_op_type(size_t i) const {
         return static_cast<OpType>(buffer[slots[i].offset]);
     }
@@ -210,16 +244,15 @@ public:
             return result;
         if (page_header->meta.isSorted) {
             for (uint16_t i = 0; i < page_header->slot_count; ++i) {
-                const Slot &slot = slots[i];
-                Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
+                key_type k = key_at(i);
                 // sorted data allows early cut
-                if (extract_key(t) < min_key) {
+                if (k < min_key) {
                     continue;
                 }
-                if (extract_key(t) > max_key) {
+                if (k > max_key) {
                     return result;
                 }
-                result.push_back(t);
+                result.push_back(td.deserialize(buffer + slots[i].offset + sizeof(OpType)));
             }
         }else { // scan
             std::unordered_set<key_type> seen;          // To store keys we've already seen
@@ -234,14 +267,13 @@ public:
                     tombstones.insert(tombstone_key);
                     continue;
                 }
-                Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-                key_type k = extract_key(t);
+                key_type k = key_at(i);
 
                 if (k < min_key || k > max_key) continue;
 
                 if (seen.contains(k) || tombstones.contains(k)) continue;
                 seen.insert(k);
-                result.push_back(t);
+                result.push_back(td.deserialize(buffer + slot.offset + sizeof(OpType)));
             }
             std::ranges::reverse(result); // maintain sorted order
         }
@@ -277,16 +309,8 @@ public:
 
     // Binary search based on keys in slots (only usable when leaf is sorted!!!)
     uint16_t value_slot(const key_type &key) const {
-        // Binary search if sorted
-        uint16_t left = 0, right = page_header->slot_count;
-        while (left < right) {
-            uint16_t mid = (left + right) / 2;
-            Slot cur = slots[mid];
-            Tuple mid_tuple = td.deserialize(buffer + slots[mid].offset+ sizeof(OpType));
-            if (extract_key(mid_tuple) < key) left = mid + 1;
-            else right = mid;
-        }
-        return left;
+        return static_cast<uint16_t>(sorted_lower_bound(
+            page_header->slot_count, key, [&](size_t i) { return key_at(i); }));
     }
 
     // Find the most recent value for key (or tombstone)
@@ -296,12 +320,9 @@ public:
         if (page_header->meta.isSorted){
             uint16_t index = value_slot(key);
 
-            if (index < page_header->slot_count) {
-                const Slot &slot = slots[index];
-                Tuple t = td.deserialize(buffer + slot.offset+ sizeof(OpType));
-                if (extract_key(t) == key) {
-                    return t;
-                }
+            if (index < page_header->slot_count && key_at(index) == key &&
+                static_cast<size_t>(slots[index].offset) + slots[index].length <= block_size) {
+                return td.deserialize(buffer + slots[index].offset + sizeof(OpType));
             }
             return std::nullopt;
         }
@@ -309,6 +330,8 @@ public:
         // unsorted, O(n)
         for (int i = static_cast<int>(page_header->slot_count) - 1; i >= 0; --i) {
             const Slot& slot = slots[i];
+            // torn slot under an optimistic read: skip, validation retries
+            if (static_cast<size_t>(slot.offset) + slot.length > block_size) continue;
             OpType op = static_cast<OpType>(buffer[slot.offset]);
             if (op == OpType::Delete) {
                 key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
@@ -318,9 +341,8 @@ public:
                 }
                 continue;  // Skip tombstones
             }
-            Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-            if (extract_key(t) == key) {
-                return t;
+            if (key_at(i) == key) {
+                return td.deserialize(buffer + slot.offset + sizeof(OpType));
             }
         }
         return std::nullopt;
@@ -344,12 +366,11 @@ public:
                 tombstones.insert(tombstone_key);
                 continue;  // Skip tombstones
             }
-            Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-            key_type k = extract_key(t);
+            key_type k = key_at(i);
 
             if (!tombstones.contains(k) && !seen.contains(k)) {
                 tombstones.insert(k);
-                compacted.push_back(t);
+                compacted.push_back(td.deserialize(buffer + slot.offset + sizeof(OpType)));
             }
             seen.insert(k);
         }
@@ -357,42 +378,99 @@ public:
         return compacted;
     }
 
-    void sort() {
-        // compact
-        std::vector<Tuple> compacted = compact();
+    // Indices of the newest live record per key (tombstoned and shadowed
+    // versions dropped), oldest first. Works purely on key_at, no tuples.
+    std::vector<uint16_t> live_slots() const {
+        std::vector<uint16_t> live;
+        std::unordered_set<key_type> seen;
+        std::unordered_set<key_type> tombstones;
 
-        // Before re-inserting into old page, clear all records
-        page_header->slot_count = 0;
-        page_header->heap_end = block_size;
-        page_header->size = 0;
-        page_header->min_key = std::numeric_limits<key_type>::max();
-        page_header->max_key = std::numeric_limits<key_type>::min();
+        for (int i = page_header->slot_count - 1; i >= 0; --i) {
+            OpType op = static_cast<OpType>(buffer[slots[i].offset]);
+            if (op == OpType::Delete) {
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slots[i].offset + sizeof(OpType));
+                tombstones.insert(tombstone_key);
+                continue;
+            }
+            key_type k = key_at(i);
+            if (!tombstones.contains(k) && !seen.contains(k)) {
+                tombstones.insert(k);
+                live.push_back(static_cast<uint16_t>(i));
+            }
+            seen.insert(k);
+        }
+        std::ranges::reverse(live);
+        return live;
+    }
+
+    // Copy raw record bytes from another page into this leaf. The record must
+    // carry its OpType prefix; min/max are maintained like insert().
+    void append_raw(const uint8_t* record, uint16_t len, key_type key) {
+        page_header->heap_end -= len;
+        std::memcpy(buffer + page_header->heap_end, record, len);
+        slots[page_header->slot_count] = {
+            static_cast<uint16_t>(page_header->heap_end),
+            len
+        };
+        ++(page_header->slot_count);
+        ++page_header->size;
+        if (key < page_header->min_key) page_header->min_key = key;
+        if (key > page_header->max_key) page_header->max_key = key;
+    }
+
+    // Rewrite the heap so it holds exactly the records in `order` (slot
+    // indices into the current layout), packed from the end of the block.
+    // Records are moved byte-for-byte via a page-sized scratch buffer, so no
+    // Tuple is ever materialized.
+    void rewrite_in_place(const std::vector<uint16_t>& order) {
+        std::array<uint8_t, block_size> scratch;
+        std::vector<Slot> new_slots(order.size());
+
+        key_type new_min = std::numeric_limits<key_type>::max();
+        key_type new_max = std::numeric_limits<key_type>::min();
+        size_t heap = block_size;
+        for (size_t i = 0; i < order.size(); ++i) {
+            const Slot& slot = slots[order[i]];
+            key_type k = key_at(order[i]);
+            heap -= slot.length;
+            std::memcpy(scratch.data() + heap, buffer + slot.offset, slot.length);
+            new_slots[i] = {static_cast<uint16_t>(heap), slot.length};
+            new_min = std::min(new_min, k);
+            new_max = std::max(new_max, k);
+        }
 
-        std::sort(compacted.begin(), compacted.end(), [&](const Tuple& a, const Tuple& b) {
-                return extract_key(a) < extract_key(b);
+        std::memcpy(buffer + heap, scratch.data() + heap, block_size - heap);
+        std::memcpy(slots, new_slots.data(), new_slots.size() * sizeof(Slot));
+        page_header->slot_count = order.size();
+        page_header->size = order.size();
+        page_header->heap_end = heap;
+        page_header->min_key = new_min;
+        page_header->max_key = new_max;
+    }
+
+    void sort() {
+        std::vector<uint16_t> live = live_slots();
+        std::sort(live.begin(), live.end(), [&](uint16_t a, uint16_t b) {
+                return key_at(a) < key_at(b);
             });
-        for (size_t i = 0; i < compacted.size(); ++i) insert(compacted[i]);
+        rewrite_in_place(live);
         page_header->meta.isSorted = true;
     }
 
     key_type split_into(AppendOnlyLeafNode& new_leaf) {
-        // compact
-        std::vector<Tuple> compacted = compact();
-
-        // Before re-inserting into old page, clear all records
-        page_header->slot_count = 0;
-        page_header->heap_end = block_size;
-        page_header->size = 0;
-        page_header->min_key = std::numeric_limits<key_type>::max();
-        page_header->max_key = std::numeric_limits<key_type>::min();
-
-        // split
-        std::sort(compacted.begin(), compacted.end(), [&](const Tuple& a, const Tuple& b) {
-            return extract_key(a) < extract_key(b);
+        std::vector<uint16_t> live = live_slots();
+        std::sort(live.begin(), live.end(), [&](uint16_t a, uint16_t b) {
+            return key_at(a) < key_at(b);
         });
-        size_t half = compacted.size() * 3 / 4;
-        for (size_t i = 0; i < half; ++i) insert(compacted[i]);
-        for (size_t i = half; i < compacted.size(); ++i) new_leaf.insert(compacted[i]);
+
+        // upper quarter moves to the new leaf as raw byte copies, then the
+        // remainder is packed into this page in sorted order
+        size_t half = live.size() * 3 / 4;
+        for (size_t i = half; i < live.size(); ++i) {
+            new_leaf.append_raw(buffer + slots[live[i]].offset, slots[live[i]].length, key_at(live[i]));
+        }
+        live.resize(half);
+        rewrite_in_place(live);
         page_header->meta.isSorted = true;
         new_leaf.page_header->meta.isSorted = true;
 
@@ -411,12 +489,14 @@ public:
 
         for (int i = static_cast<int>(page_header->slot_count) - 1; i >= 0; --i) {
             OpType op = static_cast<OpType>(buffer[slots[i].offset]);
-            Tuple t = td.deserialize(buffer + slots[i].offset + sizeof(OpType));
-            key_type k = extract_key(t);
 
             if (op == OpType::Delete) {
-                deleted.insert(k);
-            } else if (!deleted.contains(k)) {
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slots[i].offset + sizeof(OpType));
+                deleted.insert(tombstone_key);
+                continue;
+            }
+            key_type k = key_at(i);
+            if (!deleted.contains(k)) {
                 new_min = std::min(new_min, k);
                 new_max = std::max(new_max, k);
             }
@@ -2,17 +2,32 @@
 
 #include <string>
 #include <cstddef>
+#include <cstring>
+#include <atomic>
 #include <stdexcept>
+#include <optional>
+#include <span>
+#include <vector>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 
 #include "Tuple.hpp"
 #include "Types.hpp"  // for db::Page
+#include "WorkloadTrace.hpp"
 
 namespace db {
 
+    // How pages come off disk. MMAP serves reads out of a shared mapping of
+    // the file (no syscall per miss, data shared with the page cache);
+    // SYSCALL is the plain pread path. Writes always go through pwrite so
+    // dirty-page batching keeps working; the mapping stays coherent because
+    // both sides are the same page cache.
+    enum class IOMode { SYSCALL, MMAP };
+
     /**
      * @brief BaseFile provides a common interface for all tree-based storage engines.
      * Any tree (e.g., BPlusTree, OptimizedBTree) should inherit from this.
@@ -23,17 +38,53 @@ namespace db {
         // using key_type = field_t;
         int fd;  // file descriptor
         std::string filename;
+        uint32_t file_id = INVALID_FILE_ID; // interned id, assigned by Database::add
+
+        // Address-space reservation for the read mapping; only the pages
+        // the file actually covers are ever touched, the rest costs nothing.
+        static constexpr size_t MMAP_RESERVE_BYTES = 1ull << 36;
+
+        IOMode io_mode;
+        uint8_t *map_base = nullptr;
+
+        // Optional workload recorder; trees call record_op on their public
+        // entry points so attached traces capture real traffic shapes.
+        TraceRecorder *recorder = nullptr;
+
+        void record_op(TraceOp op, const field_t &key) const {
+            if (recorder != nullptr) {
+                recorder->record(op, key);
+            }
+        }
+        // bytes known to be backed by the file; reads past this would fault
+        // the mapping, so they fall back to pread (which just returns short)
+        mutable std::atomic<size_t> file_bytes{0};
+
     public:
 
-        explicit BaseFile(const std::string& filename)
-        : filename(filename) {
+        explicit BaseFile(const std::string& filename, IOMode mode = IOMode::MMAP)
+        : filename(filename), io_mode(mode) {
             fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
             if (fd < 0) {
                 throw std::runtime_error("Failed to open file: " + filename);
             }
+            struct stat st{};
+            if (fstat(fd, &st) == 0) {
+                file_bytes.store(static_cast<size_t>(st.st_size), std::memory_order_relaxed);
+            }
+            if (io_mode == IOMode::MMAP) {
+                void *base = mmap(nullptr, MMAP_RESERVE_BYTES, PROT_READ,
+                                  MAP_SHARED | MAP_NORESERVE, fd, 0);
+                if (base == MAP_FAILED) {
+                    io_mode = IOMode::SYSCALL; // degrade quietly
+                } else {
+                    map_base = static_cast<uint8_t*>(base);
+                }
+            }
         }
 
         virtual ~BaseFile() {
+            if (map_base != nullptr) munmap(map_base, MMAP_RESERVE_BYTES);
             if (fd >= 0) close(fd);
         }
 
@@ -41,27 +92,158 @@ namespace db {
             return filename;
         }
 
+        uint32_t getFileId() const {
+            return file_id;
+        }
+
+        void setFileId(uint32_t id) {
+            file_id = id;
+        }
+
         virtual void init() = 0;
 
+        /**
+         * Schema of the tuples this file stores. Schema-aware consumers
+         * (WAL replay in particular) need it to deserialize records; trees
+         * that hold a TupleDesc override.
+         */
+        virtual const TupleDesc &getTupleDesc() const {
+            throw std::logic_error("getTupleDesc: not supported by this file");
+        }
+
+        /**
+         * Stop and join any background threads this file owns. Called by
+         * ~Database before the buffer pool goes away so no worker touches
+         * freed frames; destructors call it too, so it must be idempotent.
+         */
+        virtual void stop_background() {}
+
+        /**
+         * Make the file's durable state consistent: flush its pages and
+         * persist whatever metadata a later open() needs. Called for every
+         * file during a WAL checkpoint; default is a no-op for files with
+         * no reopenable state.
+         */
+        virtual void checkpoint() {}
+
+        /**
+         * Attach (or detach, with nullptr) a workload recorder. The
+         * recorder outlives the attachment; pass nullptr before destroying
+         * it. Recording costs one lock + store per op, so it is meant for
+         * bounded capture windows, not always-on.
+         */
+        void attach_recorder(TraceRecorder *r) {
+            recorder = r;
+        }
+
         virtual void insert(const Tuple &t) = 0;
 
+        /**
+         * Insert a batch of tuples. The default just loops over insert();
+         * trees can override to amortize descents and latching across
+         * tuples that land in the same leaf.
+         */
+        virtual void insert_batch(std::span<const Tuple> tuples) {
+            for (const Tuple &t: tuples) {
+                insert(t);
+            }
+        }
+
+        /**
+         * Replace the stored tuple carrying t's key with t. Default is
+         * unsupported; trees that can update in place override. Returns
+         * false when the key does not exist.
+         */
+        virtual bool update(const Tuple &t) {
+            (void) t;
+            throw std::logic_error("update: not supported by this file");
+        }
+
         virtual std::optional<db::Tuple> get(const field_t& key) = 0;
 
         virtual std::vector<Tuple> range(const field_t &min_key, const field_t &max_key) = 0;
 
         virtual void readPage(Page& page, size_t id) const {
-            std::fill(page.begin(), page.end(), 0);
-            pread(fd, page.data(), DEFAULT_PAGE_SIZE, id * DEFAULT_PAGE_SIZE);
+            size_t offset = id * DEFAULT_PAGE_SIZE;
+            // the file grows in whole pages, so a page below file_bytes is
+            // fully backed and safe to copy straight out of the mapping
+            if (map_base != nullptr &&
+                offset + DEFAULT_PAGE_SIZE <= file_bytes.load(std::memory_order_acquire)) {
+                std::memcpy(page.data(), map_base + offset, DEFAULT_PAGE_SIZE);
+                return;
+            }
+            ssize_t n = pread(fd, page.data(), DEFAULT_PAGE_SIZE, offset);
+            if (n < 0) n = 0;
+            // only zero what pread did not fill instead of the whole page
+            if (static_cast<size_t>(n) < DEFAULT_PAGE_SIZE) {
+                std::fill(page.begin() + n, page.end(), 0);
+            }
         }
 
         virtual void writePage(const Page& page, size_t id) const {
             pwrite(fd, page.data(), DEFAULT_PAGE_SIZE, id * DEFAULT_PAGE_SIZE);
+            grow_to((id + 1) * DEFAULT_PAGE_SIZE);
+        }
+
+        /**
+         * Hint that the given page range is about to be read, e.g. the
+         * next_id leaf during a chain scan, so the kernel can fault it in
+         * while the current leaf is being processed. Purely advisory.
+         */
+        virtual void prefetchPages(size_t id, size_t count) const {
+            size_t offset = id * DEFAULT_PAGE_SIZE;
+            size_t len = count * DEFAULT_PAGE_SIZE;
+            if (offset + len > file_bytes.load(std::memory_order_acquire)) return;
+            if (map_base != nullptr) {
+                madvise(map_base + offset, len, MADV_WILLNEED);
+            } else {
+                posix_fadvise(fd, static_cast<off_t>(offset), static_cast<off_t>(len),
+                              POSIX_FADV_WILLNEED);
+            }
+        }
+
+        /**
+         * Write a batch of pages, assumed sorted by page id. Runs of
+         * consecutive ids are coalesced into a single pwritev so a burst of
+         * dirty 4KB pages becomes a few large sequential writes.
+         */
+        virtual void writePages(const std::vector<std::pair<size_t, const Page*>>& batch) const {
+            size_t i = 0;
+            while (i < batch.size()) {
+                size_t run = 1;
+                while (i + run < batch.size() &&
+                       batch[i + run].first == batch[i].first + run &&
+                       run < IOV_MAX) {
+                    ++run;
+                }
+                if (run == 1) {
+                    writePage(*batch[i].second, batch[i].first);
+                } else {
+                    std::vector<iovec> iov(run);
+                    for (size_t j = 0; j < run; ++j) {
+                        iov[j].iov_base = const_cast<uint8_t*>(batch[i + j].second->data());
+                        iov[j].iov_len = DEFAULT_PAGE_SIZE;
+                    }
+                    pwritev(fd, iov.data(), static_cast<int>(run), batch[i].first * DEFAULT_PAGE_SIZE);
+                    grow_to((batch[i].first + run) * DEFAULT_PAGE_SIZE);
+                }
+                i += run;
+            }
         }
 
         virtual size_t getNumPages() const {
             off_t file_size = lseek(fd, 0, SEEK_END);
             return static_cast<size_t>(file_size) / DEFAULT_PAGE_SIZE;
         }
+
+    private:
+        // advance the known file length after a write extends it
+        void grow_to(size_t bytes) const {
+            size_t cur = file_bytes.load(std::memory_order_relaxed);
+            while (bytes > cur &&
+                   !file_bytes.compare_exchange_weak(cur, bytes, std::memory_order_release)) {
+            }
+        }
     };
 
 } // namespace db
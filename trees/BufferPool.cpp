@@ -1,50 +1,187 @@
 #include "BufferPool.hpp"
 #include "Database.hpp"  // Only needed in cpp, not in hpp
 
+#include <algorithm>
+#include <chrono>
 #include <numeric>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
 
 namespace db {
-    BufferPool::BufferPool() : free_list(POOL_SIZE) {
-        std::iota(free_list.rbegin(), free_list.rend(), 0);
+    BufferPool::BufferPool(size_t pool_size) {
+        if (pool_size == 0) {
+            throw std::invalid_argument("BufferPool: pool_size must be > 0");
+        }
+        add_frames(pool_size);
+        flusher_thread = std::thread(&BufferPool::flusher_loop, this);
     }
 
     BufferPool::~BufferPool() {
+        {
+            std::lock_guard<std::mutex> lock(flusher_mutex);
+            stop_flusher = true;
+        }
+        flusher_cv.notify_all();
+        if (flusher_thread.joinable()) {
+            flusher_thread.join();
+        }
         flush_all();
     }
 
-    size_t BufferPool::fetch_slot() {
-        if (!free_list.empty()) {
-            size_t slot = free_list.back();
-            free_list.pop_back();
-            return slot;
+    void BufferPool::flusher_loop() {
+        std::unique_lock<std::mutex> lock(flusher_mutex);
+        while (!stop_flusher) {
+            flusher_cv.wait_for(lock, std::chrono::milliseconds(50));
+            if (stop_flusher) break;
+            lock.unlock();
+            flush_batch();
+            lock.lock();
+        }
+    }
+
+    void BufferPool::flush_batch() {
+        // Harvest dirty frames under the shard locks. A frame stays dirty
+        // (and therefore unevictable) until its flushed_version catches up,
+        // so the pages can be written without holding any lock.
+        //
+        // Pinned frames are skipped: all page modifications happen under a
+        // pin, and several call sites mark_dirty before they finish
+        // mutating. Harvesting such a frame would snapshot the final
+        // version while the bytes are still in flux and mark a torn write
+        // clean.
+        //
+        // The page bytes are copied out under the shard lock and the write
+        // issued from the copy: eviction may recycle the frame for another
+        // page while our write is in flight, and writing from the frame
+        // directly would put that page's bytes at this page's disk offset.
+        struct Pending {
+            size_t slot;
+            PageId pid;
+            uint64_t version;
+            Page copy;
+        };
+        std::vector<Pending> pending;
+        for (Shard &shard: shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (size_t slot: shard.owned_slots) {
+                Frame &frame = frame_at(slot);
+                if (frame.used && frame.is_dirty() &&
+                    frame.pins.load(std::memory_order_relaxed) == 0) {
+                    frame.flush_in_flight.store(true, std::memory_order_relaxed);
+                    pending.push_back({slot, frame.pid,
+                                       frame.dirty_version.load(std::memory_order_relaxed),
+                                       page_at(slot)});
+                }
+            }
         }
+        if (pending.empty()) return;
 
-        // no available slots, evict
-        for (auto it = lru.rbegin(); it != lru.rend(); ++it) {
-            if (pin_count[*it] == 0) {
-                size_t slot = *it;
-                const PageId& old_id = slot_to_id.at(slot);
-                evict(old_id);
-                free_list.pop_back();
-                // std::cout << "[Thread " << std::this_thread::get_id() << " get slot=" << slot << " by evict"<<std::endl;
-                return slot;
+        // Group by file and sort by page id so runs coalesce into pwritev.
+        std::sort(pending.begin(), pending.end(), [](const Pending &a, const Pending &b) {
+            return a.pid.file_id != b.pid.file_id ? a.pid.file_id < b.pid.file_id
+                                                  : a.pid.page < b.pid.page;
+        });
+        size_t i = 0;
+        while (i < pending.size()) {
+            size_t j = i;
+            std::vector<std::pair<size_t, const Page*>> batch;
+            while (j < pending.size() && pending[j].pid.file_id == pending[i].pid.file_id) {
+                batch.emplace_back(pending[j].pid.page, &pending[j].copy);
+                ++j;
             }
+            getDatabase().get(pending[i].pid.file_id).writePages(batch);
+            flushes.inc(batch.size());
+            i = j;
         }
 
-        throw std::runtime_error("BufferPool::fetch_slot: No available slot to evict!");
+        // Record what was written; pages dirtied again mid-write keep a
+        // newer dirty_version and stay dirty.
+        for (const Pending &p: pending) {
+            Shard &shard = shards[p.slot % NUM_SHARDS];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Frame &frame = frame_at(p.slot);
+            if (frame.used && frame.pid == p.pid && frame.flushed_version < p.version) {
+                frame.flushed_version = p.version;
+            }
+            frame.flush_in_flight.store(false, std::memory_order_relaxed);
+        }
     }
 
-    void BufferPool::touch(size_t slot) {
-        if (!slot_lru_map.contains(slot)) {
-            throw std::runtime_error("touch: slot not found in slot_lru_map!");
+    void BufferPool::add_frames(size_t additional) {
+        size_t target = num_frames + additional;
+        while (num_frames < target) {
+            page_segments.emplace_back(new Page[SEGMENT_FRAMES]);
+            frame_segments.emplace_back(new Frame[SEGMENT_FRAMES]);
+            for (size_t i = 0; i < SEGMENT_FRAMES; ++i) {
+                size_t slot = num_frames + i;
+                Shard &shard = shards[slot % NUM_SHARDS];
+                shard.owned_slots.push_back(slot);
+                shard.free_list.push_back(slot);
+            }
+            num_frames += SEGMENT_FRAMES;
         }
+    }
 
-        lru.erase(slot_lru_map[slot]);
-        lru.push_front(slot);
-        slot_lru_map[slot] = lru.begin();
+    void BufferPool::ensure_capacity(size_t min_frames) {
+        // Take every shard lock so no lookup races the segment vectors.
+        std::array<std::unique_lock<std::mutex>, NUM_SHARDS> locks;
+        for (size_t s = 0; s < NUM_SHARDS; ++s) {
+            locks[s] = std::unique_lock<std::mutex>(shards[s].mutex);
+        }
+        if (min_frames > num_frames) {
+            add_frames(min_frames - num_frames);
+        }
+    }
+
+    size_t BufferPool::fetch_slot(size_t shard_idx) {
+        Shard &shard = shards[shard_idx];
+        if (!shard.free_list.empty()) {
+            size_t slot = shard.free_list.back();
+            shard.free_list.pop_back();
+            return slot;
+        }
+
+        // CLOCK sweep: give every referenced frame a second chance, evict the
+        // first unpinned clean frame whose reference bit is already clear.
+        // Dirty frames are left for the background flusher so eviction does
+        // not pay a synchronous write; if only dirty victims exist we fall
+        // back to one inline flush rather than fail.
+        const size_t owned = shard.owned_slots.size();
+        bool saw_dirty = false;
+        size_t dirty_victim = 0;
+        for (size_t step = 0; step < 2 * owned; ++step) {
+            size_t slot = shard.owned_slots[shard.clock_hand];
+            shard.clock_hand = (shard.clock_hand + 1) % owned;
+
+            Frame &frame = frame_at(slot);
+            if (frame.pins.load(std::memory_order_relaxed) > 0) continue;
+            if (frame.flush_in_flight.load(std::memory_order_relaxed)) continue;
+            if (frame.ref.exchange(0, std::memory_order_relaxed)) continue;
+            if (frame.is_dirty()) {
+                if (!saw_dirty) {
+                    saw_dirty = true;
+                    dirty_victim = slot;
+                }
+                continue;
+            }
+
+            evict_locked(shard, slot);
+            shard.free_list.pop_back();
+            return slot;
+        }
+
+        if (saw_dirty) {
+            flusher_cv.notify_one();
+            flush_slot(dirty_victim);
+            evict_locked(shard, dirty_victim);
+            shard.free_list.pop_back();
+            return dirty_victim;
+        }
+
+        // Every frame is pinned or has a flush in flight right now; the
+        // caller drops the shard lock and retries.
+        return NO_SLOT;
     }
 
     const Page &BufferPool::get_page(const PageId &id) {
@@ -52,100 +189,144 @@ namespace db {
     }
 
     Page &BufferPool::get_mut_page(const PageId &pid) {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-
-        if (pid_to_slot.contains(pid)) {
-            size_t slot = pid_to_slot.at(pid);
-            touch(slot);
-            pin_page(pid);
-            return pages[slot];
-        }
-
-        size_t slot = fetch_slot();
-        Page &page = pages[slot];
-        getDatabase().get(pid.file).readPage(page, pid.page);
-        pid_to_slot[pid] = slot;
-        slot_to_id[slot] = pid;
-        pin_page(pid); // pin the page
-        lru.push_front(slot);
-        slot_lru_map[slot] = lru.begin();
-        // std::cout << "[Thread " << std::this_thread::get_id()
-        //               << "] getting page for  "
-        //               << " (PageId=" << pid.page << "at slot=" << slot
-        //               << std::endl;
-        return page;
+        size_t shard_idx = shard_index(pid);
+        Shard &shard = shards[shard_idx];
+
+        for (int attempt = 0;; ++attempt) {
+            {
+                std::lock_guard<std::mutex> lock(shard.mutex);
+
+                if (auto it = shard.pid_to_slot.find(pid); it != shard.pid_to_slot.end()) {
+                    size_t slot = it->second;
+                    Frame &frame = frame_at(slot);
+                    frame.ref.store(1, std::memory_order_relaxed);
+                    frame.pins.fetch_add(1, std::memory_order_relaxed);
+                    shard.hits.inc();
+                    return page_at(slot);
+                }
+
+                size_t slot = fetch_slot(shard_idx);
+                if (slot != NO_SLOT) {
+                    shard.misses.inc();
+                    Page &page = page_at(slot);
+                    getDatabase().get(pid.file_id).readPage(page, pid.page);
+                    shard.pid_to_slot[pid] = slot;
+                    Frame &frame = frame_at(slot);
+                    frame.pid = pid;
+                    frame.used = true;
+                    frame.dirty_version.store(0, std::memory_order_relaxed);
+                    frame.flushed_version = 0;
+                    frame.ref.store(1, std::memory_order_relaxed);
+                    frame.pins.fetch_add(1, std::memory_order_relaxed); // pin the page
+                    return page;
+                }
+            }
+
+            // Shard momentarily unevictable (everything pinned or being
+            // flushed); wait outside the lock so the flusher can finish.
+            if (attempt >= 10000) {
+                throw std::runtime_error("BufferPool::get_mut_page: no evictable frame");
+            }
+            flusher_cv.notify_one();
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    OptimisticLatch &BufferPool::page_latch(const PageId &id) {
+        Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return frame_at(shard.pid_to_slot.at(id)).latch;
     }
 
     void BufferPool::mark_dirty(const PageId &id) {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        size_t slot = pid_to_slot.at(id);
-        dirty_slots.insert(slot);
+        Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.pid_to_slot.at(id);
+        frame_at(slot).dirty_version.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void BufferPool::flush_slot(size_t slot) {
+        Frame &frame = frame_at(slot);
+        if (!frame.is_dirty()) return;
+        // A background snapshot of this page is on its way to disk; writing
+        // now could be overtaken by that older snapshot. The frame stays
+        // dirty and is picked up again once the flight completes.
+        if (frame.flush_in_flight.load(std::memory_order_relaxed)) return;
+        uint64_t version = frame.dirty_version.load(std::memory_order_relaxed);
+        const Page &page = page_at(slot);
+        getDatabase().get(frame.pid.file_id).writePage(page, frame.pid.page);
+        frame.flushed_version = version;
+        flushes.inc();
     }
 
     void BufferPool::flush(const PageId &id) {
-        // if (!pid_to_slot.contains(id)) {
-        //     throw std::runtime_error("flush: PageId not found in pid_to_slot!");
-        // }
-        size_t slot = pid_to_slot.at(id);
-        if (dirty_slots.erase(slot) == 0) return;
-        const Page &page = pages[slot];
-        getDatabase().get(id.file).writePage(page, id.page);
+        Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.pid_to_slot.at(id);
+        flush_slot(slot);
     }
 
     void BufferPool::flush_all() {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        for (const size_t &slot: dirty_slots) {
-            const Page &page = pages[slot];
-            const PageId &pid = slot_to_id.at(slot);
-            getDatabase().get(pid.file).writePage(page, pid.page);
+        for (Shard &shard: shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (size_t slot: shard.owned_slots) {
+                if (frame_at(slot).used) flush_slot(slot);
+            }
         }
-        dirty_slots.clear();
     }
 
     void BufferPool::flushFile(const std::string &file) {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        std::vector<size_t> to_flush;
-        for (const size_t &pos: dirty_slots) {
-            const PageId &pid = slot_to_id[pos];
-            if (pid.file == file) {
-                to_flush.emplace_back(pid.page);
+        uint32_t fid = getDatabase().get(file).getFileId();
+        for (Shard &shard: shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (size_t slot: shard.owned_slots) {
+                Frame &frame = frame_at(slot);
+                if (frame.used && frame.pid.file_id == fid) {
+                    flush_slot(slot);
+                }
             }
         }
-        for (const auto &page: to_flush) {
-            flush({file, page});
+    }
+
+    void BufferPool::evict_locked(Shard &shard, size_t slot) {
+        Frame &frame = frame_at(slot);
+        if (frame.is_dirty()) {
+            flush_slot(slot);
         }
+        // clean page, discard
+        shard.pid_to_slot.erase(frame.pid);
+        frame.used = false;
+        frame.ref.store(0, std::memory_order_relaxed);
+        shard.free_list.push_back(slot);
+        shard.evictions.inc();
     }
 
     void BufferPool::evict(const PageId &id) {
-        if (!pid_to_slot.contains(id)) {
+        Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.pid_to_slot.contains(id)) {
             throw std::runtime_error("evict: PageId not found in pid_to_slot!");
         }
-        size_t slot = pid_to_slot.at(id);
-        if (dirty_slots.contains(slot)) {
-            flush(id);
-        }
-        // clean page, discard
-        pid_to_slot.erase(id);
-        slot_to_id.erase(slot);
-        lru.erase(slot_lru_map[slot]);
-        slot_lru_map.erase(slot);
-        free_list.push_back(slot);
+        evict_locked(shard, shard.pid_to_slot.at(id));
     }
 
     void BufferPool::pin_page(const PageId &id) {
-        size_t slot = pid_to_slot.at(id);
-        pin_count[slot].fetch_add(1, std::memory_order_relaxed);
+        Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.pid_to_slot.at(id);
+        frame_at(slot).pins.fetch_add(1, std::memory_order_relaxed);
     }
 
     void BufferPool::unpin_page(const PageId &id) {
-        std::lock_guard<std::mutex> lock(pool_mutex);
-        size_t slot = pid_to_slot.at(id);
-        if (pin_count[slot].fetch_sub(1, std::memory_order_relaxed) <= 0) {
-            pin_count.erase(slot);
-        }
+        Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size_t slot = shard.pid_to_slot.at(id);
+        frame_at(slot).pins.fetch_sub(1, std::memory_order_relaxed);
     }
 
     bool BufferPool::contains(const PageId &id) const {
-        return pid_to_slot.contains(id);
+        const Shard &shard = shard_for(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.pid_to_slot.contains(id);
     }
 } // namespace db
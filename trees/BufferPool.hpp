@@ -2,37 +2,154 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <limits>
 #include <list>
+#include <memory>
 #include <vector>
 #include <array>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "OptimisticLatch.hpp"
+#include "StatsCounter.hpp"
 #include "Types.hpp"
 
 namespace db {
 
     class BufferPool {
     private:
-        std::array<Page, POOL_SIZE> pages;
-        std::vector<size_t> free_list;
-        std::unordered_map<PageId, size_t> pid_to_slot;
-        std::unordered_map<size_t, PageId> slot_to_id;
-        std::unordered_set<size_t> dirty_slots;
+        // Number of independent partitions of the page table. Pages hash to a
+        // shard by PageId, so accesses to distinct pages only contend when they
+        // land on the same shard. Must be a power of two.
+        static constexpr size_t NUM_SHARDS = 16;
 
-        std::list<size_t> lru;
-        std::unordered_map<size_t, std::list<size_t>::iterator> slot_lru_map;
+        // Frames are allocated on the heap in fixed-size segments so the pool
+        // can grow at runtime without relocating pages that are already in
+        // use (and possibly pinned). Slot ids address into segments directly.
+        static constexpr size_t SEGMENT_SHIFT = 6;
+        static constexpr size_t SEGMENT_FRAMES = 1 << SEGMENT_SHIFT; // 64 frames / 256KB
+        static constexpr size_t SEGMENT_MASK = SEGMENT_FRAMES - 1;
 
-        mutable std::mutex pool_mutex;
-        std::unordered_map<size_t, std::atomic<int>> pin_count;
+        // Returned by fetch_slot when a shard has no evictable frame at
+        // this instant (everything pinned or mid-flush).
+        static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
 
-        size_t fetch_slot();
-        void touch(size_t slot);
+        // Per-frame replacement metadata for the CLOCK (second-chance) policy.
+        // A page hit is a single relaxed store to `ref`; the eviction hand
+        // clears reference bits as it sweeps and takes the first unpinned
+        // frame whose bit is already clear.
+        //
+        // Dirtiness is tracked as a version pair: mark_dirty bumps
+        // dirty_version, a completed write records the version it saw in
+        // flushed_version. The frame is dirty while they differ, so a page
+        // re-dirtied during a background write stays dirty afterwards.
+        struct Frame {
+            PageId pid;
+            std::atomic<uint8_t> ref{0};
+            std::atomic<int> pins{0};
+            bool used = false;
+            std::atomic<uint64_t> dirty_version{0};
+            uint64_t flushed_version = 0;
+
+            // Set while the background flusher has a snapshot of this page
+            // in flight. Such a frame must be neither evicted nor written
+            // by anyone else: a fresher write could land before the
+            // flusher's older snapshot and be clobbered by it.
+            std::atomic<bool> flush_in_flight{false};
+
+            // Versioned latch for optimistic lock coupling on the page's
+            // contents. Lives with the frame so trees need no side table;
+            // a pinned frame is never reused, which keeps the latch stable
+            // for whoever holds the pin.
+            OptimisticLatch latch;
+
+            bool is_dirty() const {
+                return dirty_version.load(std::memory_order_relaxed) != flushed_version;
+            }
+        };
+
+        // Each shard owns a set of slots along with its own page table, clock
+        // hand and mutex. Eviction is shard-local.
+        struct Shard {
+            std::unordered_map<PageId, size_t> pid_to_slot;
+            std::vector<size_t> owned_slots;
+            std::vector<size_t> free_list;
+            size_t clock_hand = 0; // index into owned_slots
+            mutable std::mutex mutex;
+
+            // shard-local so the stats themselves add no cross-shard traffic
+            StatCounter hits;
+            StatCounter misses;
+            StatCounter evictions;
+        };
+
+        std::vector<std::unique_ptr<Page[]>> page_segments;
+        std::vector<std::unique_ptr<Frame[]>> frame_segments;
+        size_t num_frames = 0;
+        std::array<Shard, NUM_SHARDS> shards;
+
+        // Background write-back: eviction prefers clean frames and hands
+        // dirty ones to this thread, which harvests them in (file, page)
+        // order and writes them in large batches off the critical path.
+        std::thread flusher_thread;
+        std::mutex flusher_mutex;
+        std::condition_variable flusher_cv;
+        bool stop_flusher = false;
+
+        void flusher_loop();
+        void flush_batch();
+
+        Page& page_at(size_t slot) {
+            return page_segments[slot >> SEGMENT_SHIFT][slot & SEGMENT_MASK];
+        }
+
+        Frame& frame_at(size_t slot) {
+            return frame_segments[slot >> SEGMENT_SHIFT][slot & SEGMENT_MASK];
+        }
+
+        static size_t shard_index(const PageId& id) {
+            return std::hash<PageId>()(id) & (NUM_SHARDS - 1);
+        }
+
+        Shard& shard_for(const PageId& id) {
+            return shards[shard_index(id)];
+        }
+
+        const Shard& shard_for(const PageId& id) const {
+            return shards[shard_index(id)];
+        }
+
+        // Allocates segments and hands the new slots to the shards
+        // round-robin. Callers must hold all shard mutexes (or be the
+        // constructor).
+        void add_frames(size_t additional);
+
+        // All helpers below expect the shard mutex to be held by the caller.
+        size_t fetch_slot(size_t shard_idx);
+        void flush_slot(size_t slot);
+        void evict_locked(Shard& shard, size_t slot);
 
     public:
-        BufferPool();
+        explicit BufferPool(size_t pool_size = POOL_SIZE);
         ~BufferPool();
 
+        // Grow the pool so it holds at least min_frames frames. Existing
+        // frames are never relocated, so this is safe while pages are pinned.
+        void ensure_capacity(size_t min_frames);
+
+        size_t capacity() const {
+            return num_frames;
+        }
+
         const Page& get_page(const PageId& id);
         Page& get_mut_page(const PageId& pid);
 
+        // Versioned latch of the frame currently holding id. The caller
+        // must already hold a pin on the page (a get_mut_page it has not
+        // yet unpinned), otherwise the frame may be recycled under it.
+        OptimisticLatch& page_latch(const PageId& id);
+
         void mark_dirty(const PageId& id);
         void flush(const PageId& id);
         void flush_all();
@@ -41,6 +158,30 @@ namespace db {
         void pin_page(const PageId& id);
         void unpin_page(const PageId& id);
         bool contains(const PageId& id) const;
+
+        // Plain-value snapshot of the pool counters for monitoring; relaxed
+        // reads, so the fields are individually accurate but not a
+        // consistent cut across shards.
+        struct Stats {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            uint64_t flushes;
+        };
+
+        Stats get_stats() const {
+            Stats s{0, 0, 0, flushes.get()};
+            for (const Shard &shard: shards) {
+                s.hits += shard.hits.get();
+                s.misses += shard.misses.get();
+                s.evictions += shard.evictions.get();
+            }
+            return s;
+        }
+
+    private:
+        // pages written back, inline and by the background flusher
+        StatCounter flushes;
     };
 
 } // namespace db
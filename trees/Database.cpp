@@ -7,9 +7,23 @@
 
 using namespace db;
 
+Database::~Database() {
+    for (auto &[name, file]: files) {
+        file->stop_background();
+    }
+}
+
 void Database::add(std::unique_ptr<BaseFile> tree) {
     const std::string &name = tree->getName();
     std::cout << "[Database] add file: " << name << std::endl;
+    if (files.contains(name)) {
+        // The old file is about to be destroyed; push its dirty pages out
+        // while its descriptor is still open. Its id is never reused, so any
+        // stale clean pages left in the pool can not alias the new file.
+        buffer_pool.flushFile(name);
+    }
+    tree->setFileId(static_cast<uint32_t>(files_by_id.size()));
+    files_by_id.push_back(tree.get());
     files[name] = std::move(tree);
 }
 
@@ -17,10 +31,51 @@ BaseFile &Database::get(const std::string &name) const {
     return *files.at(name);
 }
 
+BaseFile &Database::get(uint32_t file_id) const {
+    return *files_by_id.at(file_id);
+}
+
 BufferPool &Database::getBufferPool() {
     return buffer_pool;
 }
 
+void Database::enableWAL(const std::string &path) {
+    wal = std::make_unique<WriteAheadLog>(path);
+}
+
+WriteAheadLog *Database::getWAL() const {
+    return wal.get();
+}
+
+size_t Database::recoverWAL() {
+    if (wal == nullptr) {
+        throw std::logic_error("recoverWAL: no WAL enabled");
+    }
+    return wal->replay(*this);
+}
+
+void Database::checkpointWAL() {
+    if (wal == nullptr) {
+        throw std::logic_error("checkpointWAL: no WAL enabled");
+    }
+    uint64_t mark = wal->checkpoint();
+    // flush_all above made the data pages durable; now each file can
+    // publish a superblock that points at them
+    for (auto &[name, file]: files) {
+        file->checkpoint();
+    }
+    // Only now is everything the mark claims on disk, so replay may start
+    // there. A crash before this line keeps the old floor: open() restores
+    // newer superblocks and replay re-applies a few records they already
+    // cover, which inserts absorb as shadowed versions — never the reverse,
+    // where the floor claims state that was not written.
+    wal->publish_checkpoint(mark);
+}
+
+void Database::configureBufferPool(size_t frames) {
+    buffer_pool.ensure_capacity(frames);
+}
+
 Database &db::getDatabase() {
     static Database instance;
     return instance;
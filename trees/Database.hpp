@@ -1,18 +1,31 @@
 #pragma once
 
+#include <memory>
+
 #include "BufferPool.hpp"
 #include "BaseFile.hpp"
+#include "WriteAheadLog.hpp"
 
 namespace db {
     class Database {
         std::unordered_map<std::string, std::unique_ptr<BaseFile>> files;
+        std::vector<BaseFile*> files_by_id; // index is the interned file id
 
         BufferPool buffer_pool;
 
+        // Optional durability; null until enableWAL. Trees check getWAL()
+        // on their mutation paths, so leaving it off costs one load.
+        std::unique_ptr<WriteAheadLog> wal;
+
         Database() = default;
 
     public:
 
+        // Members are destroyed in reverse declaration order, so the buffer
+        // pool dies before the files. Join every file's background workers
+        // first or they would race the pool teardown.
+        ~Database();
+
         friend Database &getDatabase();
 
         Database(Database const &) = delete;
@@ -27,8 +40,28 @@ namespace db {
 
         BufferPool &getBufferPool();
 
+        // Grow the buffer pool to at least the given number of frames.
+        // Shrinking is not supported; smaller values are a no-op.
+        void configureBufferPool(size_t frames);
+
         BaseFile &get(const std::string &name) const;
 
+        BaseFile &get(uint32_t file_id) const;
+
+        // Turn on write-ahead logging; every subsequent tree mutation
+        // appends a redo record and rides the group commit.
+        void enableWAL(const std::string &path);
+
+        // Null while no WAL is enabled.
+        WriteAheadLog *getWAL() const;
+
+        // Replay the enabled WAL into the registered files. Call once at
+        // startup, after every file is added and init()'ed.
+        size_t recoverWAL();
+
+        // Flush all dirty pages and mark the log.
+        void checkpointWAL();
+
         // std::unique_ptr<BaseFile> remove(const std::string &name);
     };
 
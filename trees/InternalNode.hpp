@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <vector>
 #include <stdexcept>
+#include "KeySearch.hpp"
 #include "NodeTypes.hpp"
 
 using namespace db;
@@ -49,8 +50,7 @@ public:
     }
 
     uint16_t child_slot(const key_type& key) const {
-        auto it = std::upper_bound(keys, keys + header->size, key);
-        return std::distance(keys, it);
+        return static_cast<uint16_t>(sorted_upper_bound(keys, header->size, key));
     }
 
     void copyInfoFrom(const InternalNode& other) {
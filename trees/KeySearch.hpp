@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace db {
+
+    // Search kernels for the sorted key arrays inside tree nodes. The
+    // descent spends most of its read-path time here, so the arithmetic-key
+    // paths avoid the branch mispredictions of std::upper_bound: the binary
+    // search steps compile to conditional moves, and with AVX2 the final
+    // window of 32-bit keys is resolved with compare + movemask + popcount
+    // instead of more probes. Non-arithmetic key types fall back to the
+    // standard algorithms.
+
+#if defined(__AVX2__)
+    // Number of keys in [a, a + n) that are <= key. Element-wise, so it
+    // does not rely on the array being sorted.
+    inline size_t count_le_epi32(const int32_t* a, size_t n, int32_t key) {
+        const __m256i kv = _mm256_set1_epi32(key);
+        size_t i = 0;
+        size_t count = 0;
+        for (; i + 8 <= n; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            __m256i gt = _mm256_cmpgt_epi32(v, kv);
+            unsigned mask = static_cast<unsigned>(
+                _mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+            count += 8 - static_cast<size_t>(__builtin_popcount(mask));
+        }
+        for (; i < n; ++i) {
+            count += a[i] <= key;
+        }
+        return count;
+    }
+#endif
+
+    // First index in the sorted, packed array whose key compares greater
+    // than key (what std::upper_bound returns).
+    template<typename key_type>
+    inline size_t sorted_upper_bound(const key_type* keys, size_t n, const key_type& key) {
+        if constexpr (std::is_arithmetic_v<key_type>) {
+            const key_type* base = keys;
+            size_t len = n;
+#if defined(__AVX2__)
+            if constexpr (std::is_integral_v<key_type> && std::is_signed_v<key_type> &&
+                          sizeof(key_type) == 4) {
+                while (len > 32) {
+                    size_t half = len / 2;
+                    base += (base[half - 1] <= key) ? half : 0;
+                    len -= half;
+                }
+                return static_cast<size_t>(base - keys) +
+                       count_le_epi32(reinterpret_cast<const int32_t*>(base), len,
+                                      static_cast<int32_t>(key));
+            }
+#endif
+            while (len > 1) {
+                size_t half = len / 2;
+                base += (base[half - 1] <= key) ? half : 0;
+                len -= half;
+            }
+            return static_cast<size_t>(base - keys) + (n > 0 && *base <= key ? 1 : 0);
+        } else {
+            return static_cast<size_t>(std::upper_bound(keys, keys + n, key) - keys);
+        }
+    }
+
+    // Shortest separator s with left_max < s <= right_min. Splits may
+    // publish any such s in the parent — descents route key < s to the
+    // left child — and a shorter s raises internal fanout once keys are
+    // variable-length. Fixed-width arithmetic keys are already minimal
+    // and pass through unchanged; string-like keys are cut one element
+    // past the common prefix of the two inputs.
+    //
+    // Future variable-length instantiations beware: the concurrent insert
+    // path reads the right sibling's minimum as the split fence when it
+    // revalidates a descent, which is exact only while s == right_min. A
+    // genuinely truncated s must also be stored as the right leaf's lower
+    // fence before that assumption can be relaxed.
+    template<typename key_type>
+    inline key_type truncate_separator(const key_type& left_max, const key_type& right_min) {
+        if constexpr (std::is_arithmetic_v<key_type>) {
+            (void) left_max;
+            return right_min;
+        } else {
+            size_t common = 0;
+            size_t n = std::min(std::size(left_max), std::size(right_min));
+            while (common < n && left_max[common] == right_min[common]) ++common;
+            // one element past the shared prefix already compares > left_max
+            size_t keep = std::min(common + 1, std::size(right_min));
+            return key_type(std::begin(right_min), std::begin(right_min) + keep);
+        }
+    }
+
+    // First index i in [0, n) with key_at(i) >= key, for leaves whose keys
+    // sit behind a slot indirection rather than packed; same
+    // conditional-move shape as above.
+    template<typename key_type, typename KeyAt>
+    inline size_t sorted_lower_bound(size_t n, const key_type& key, KeyAt&& key_at) {
+        if (n == 0) return 0;
+        size_t base = 0;
+        size_t len = n;
+        while (len > 1) {
+            size_t half = len / 2;
+            base += (key_at(base + half - 1) < key) ? half : 0;
+            len -= half;
+        }
+        return base + (key_at(base) < key ? 1 : 0);
+    }
+
+} // namespace db
@@ -5,6 +5,7 @@
 #include <random>
 #include <vector>
 #include <unordered_set>
+#include "KeySearch.hpp"
 #include "NodeTypes.hpp"
 #include "Tuple.hpp"
 
@@ -32,8 +33,22 @@ public:
         node_id_type next_id;
         bool isSorted;
         bool isCold;
+        // set when the leaf is absorbed into its left sibling by a merge;
+        // the page keeps its data for in-flight readers, but writers that
+        // raced the merge must re-descend instead of inserting here
+        bool isDead;
     };
 
+    // Per-leaf Bloom filter over the stored keys, kept in the page header
+    // so it travels with the page through the buffer pool and to disk.
+    // 2048 bits / 4 probes gives a few-percent false-positive rate at
+    // typical leaf occupancy; absent-key lookups exit on the first clear
+    // bit instead of scanning every slot of an unsorted leaf. Costs 256
+    // bytes of heap space per page.
+    static constexpr size_t FILTER_BITS = 2048;
+    static constexpr size_t FILTER_WORDS = FILTER_BITS / 64;
+    static constexpr int FILTER_HASHES = 4;
+
     struct PageHeader {
         node_id_type id; // node id
         uint16_t size; // number of tuples
@@ -43,6 +58,7 @@ public:
         key_type min_key;
         key_type max_key;
         size_t heap_end;
+        uint64_t filter[FILTER_WORDS];
     };
 
     static constexpr uint16_t available_space = block_size - (sizeof(BaseHeader) + sizeof(PageHeader));
@@ -50,6 +66,17 @@ public:
     uint8_t* buffer;
     const TupleDesc& td;
     size_t key_index{};
+    size_t key_offset{};   // byte offset of the key within a serialized record
+    bool key_fixed{false}; // true when the key sits at a fixed offset
+
+    // Dense fixed-stride layout, chosen once per file in init_key_offset
+    // when the schema is fully fixed-width (no VARCHAR): record i sits at
+    // block_size - (i + 1) * record_stride, so the slot directory and the
+    // per-record length bookkeeping disappear and a page holds more
+    // records. Tombstones are padded to the stride to keep the offsets
+    // implicit. Schemas with VARCHAR keep the slotted layout.
+    bool fixed_layout{false};
+    size_t record_stride{0}; // sizeof(OpType) + the schema's fixed length
 
     BaseHeader* base_header;
     PageHeader* page_header;
@@ -65,6 +92,7 @@ public:
         base_header = reinterpret_cast<BaseHeader*>(buffer);
         page_header = reinterpret_cast<PageHeader*>(buffer + sizeof(BaseHeader));
         slots = reinterpret_cast<Slot*>(buffer + sizeof(BaseHeader) + sizeof(PageHeader));
+        init_key_offset();
     }
 
     LasLeafNode(Page &page, const TupleDesc& desc, size_t key, node_id_type id, node_id_type next_id, bool isCold)
@@ -75,17 +103,20 @@ public:
         base_header = reinterpret_cast<BaseHeader*>(buffer);
         page_header = reinterpret_cast<PageHeader*>(buffer + sizeof(BaseHeader));
         slots = reinterpret_cast<Slot*>(buffer + sizeof(BaseHeader) + sizeof(PageHeader));
+        init_key_offset();
 
         base_header->type = 0;
         page_header->id = id;
         page_header->meta.next_id = next_id;
         page_header->meta.isSorted = false;
         page_header->meta.isCold = isCold;
+        page_header->meta.isDead = false;
         page_header->size = 0;
         page_header->slot_count = 0;
         page_header->min_key = std::numeric_limits<key_type>::max();
         page_header->max_key = std::numeric_limits<key_type>::min();
         page_header->heap_end = block_size;
+        filter_clear();
     }
 
     node_id_type get_id() {
@@ -108,6 +139,94 @@ public:
         return std::get<key_type>(t.get_field(key_index));
     }
 
+    void init_key_offset() {
+        if (auto offset = td.fixed_field_offset(key_index)) {
+            key_offset = *offset;
+            key_fixed = true;
+        }
+        if (auto len = td.fixed_length()) {
+            fixed_layout = true;
+            record_stride = sizeof(OpType) + *len;
+        }
+    }
+
+    // Byte offset / length of record i under either layout. In the dense
+    // layout both are pure arithmetic, so lookups never touch a slot
+    // directory cache line.
+    size_t rec_offset(size_t i) const {
+        return fixed_layout ? block_size - (i + 1) * record_stride : slots[i].offset;
+    }
+
+    size_t rec_length(size_t i) const {
+        return fixed_layout ? record_stride : slots[i].length;
+    }
+
+    // Read the key of slot i straight out of the serialized record; only
+    // falls back to full Tuple deserialization when the key is not at a
+    // fixed offset. Callers must not pass a tombstone slot.
+    //
+    // An optimistic reader racing a writer can observe a torn slot; never
+    // chase an offset outside the page — latch validation makes the reader
+    // retry, so returning a garbage key here is harmless.
+    key_type key_at(size_t i) const {
+        const size_t off = rec_offset(i);
+        if (off + rec_length(i) > block_size) {
+            return key_type{};
+        }
+        if constexpr (std::is_arithmetic_v<key_type>) {
+            if (key_fixed) {
+                key_type k;
+                std::memcpy(&k, buffer + off + sizeof(OpType) + key_offset, sizeof(key_type));
+                return k;
+            }
+        }
+        return std::get<key_type>(td.read_field(buffer + off + sizeof(OpType), key_index));
+    }
+
+    // One 64-bit finalizer feeds all probes: four 11-bit slices of the
+    // mixed hash pick the bits, so adjacent keys still spread across the
+    // whole filter.
+    static uint64_t filter_hash(const key_type &key) {
+        uint64_t x;
+        if constexpr (std::is_arithmetic_v<key_type>) {
+            x = static_cast<uint64_t>(key);
+        } else {
+            x = std::hash<key_type>{}(key);
+        }
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    void filter_add(const key_type &key) {
+        uint64_t h = filter_hash(key);
+        for (int i = 0; i < FILTER_HASHES; ++i) {
+            size_t bit = (h >> (i * 11)) & (FILTER_BITS - 1);
+            page_header->filter[bit >> 6] |= 1ull << (bit & 63);
+        }
+    }
+
+    // May say yes for absent keys (bounded false-positive rate), never no
+    // for a key this leaf holds. Tombstoned keys stay in the filter; the
+    // slot scan behind the probe still resolves them to "deleted".
+    bool filter_may_contain(const key_type &key) const {
+        uint64_t h = filter_hash(key);
+        for (int i = 0; i < FILTER_HASHES; ++i) {
+            size_t bit = (h >> (i * 11)) & (FILTER_BITS - 1);
+            if ((page_header->filter[bit >> 6] & (1ull << (bit & 63))) == 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void filter_clear() {
+        std::memset(page_header->filter, 0, sizeof(page_header->filter));
+    }
+
     key_type min_key() const {
         return page_header->min_key;
     }
@@ -117,14 +236,20 @@ public:
     }
 
     OpType get_op_type(size_t i) const {
-        return static_cast<OpType>(buffer[slots[i].offset]);
+        return static_cast<OpType>(buffer[rec_offset(i)]);
     }
 
     size_t used_space() const {
-        return block_size - page_header->heap_end + sizeof(Slot) * (page_header->slot_count);
+        size_t slot_bytes = fixed_layout ? 0 : sizeof(Slot) * page_header->slot_count;
+        return block_size - page_header->heap_end + slot_bytes;
     }
 
     bool can_insert(size_t tuple_len) const {
+        if (fixed_layout) {
+            // every record costs exactly one stride and no slot entry
+            return page_header->heap_end >=
+                   sizeof(BaseHeader) + sizeof(PageHeader) + record_stride;
+        }
         size_t new_offset = page_header->heap_end - tuple_len;
         size_t end_offset = sizeof(BaseHeader) + sizeof(PageHeader) + sizeof(Slot) * (page_header->slot_count + 1);
 
@@ -134,28 +259,27 @@ public:
     void print_page_debug() const {
         std::cout << "  Slots (" << page_header->slot_count << "):" << std::endl;
         for (size_t i = 0; i < page_header->slot_count; ++i) {
-            const auto& slot = slots[i];
-            OpType op = static_cast<OpType>(buffer[slot.offset]);
+            OpType op = static_cast<OpType>(buffer[rec_offset(i)]);
 
-            std::cout << "    [" << i << "]: offset=" << slot.offset
-                      << ", length=" << slot.length
+            std::cout << "    [" << i << "]: offset=" << rec_offset(i)
+                      << ", length=" << rec_length(i)
                       << ", op=" << (op == OpType::Insert ? "Insert" : "Delete")
                       << std::endl;
         }
 
         std::cout << "  Heap content:" << std::endl;
         for (size_t i = 0; i < page_header->slot_count; ++i) {
-            const auto& slot = slots[i];
-            OpType op = static_cast<OpType>(buffer[slot.offset]);
+            const size_t off = rec_offset(i);
+            OpType op = static_cast<OpType>(buffer[off]);
 
             if (op == OpType::Delete) {
-                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + off + sizeof(OpType));
                 std::cout
                       << "Tombstone: key= " << tombstone_key
                       << std::endl;
                 continue;
             }
-            Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
+            Tuple t = td.deserialize(buffer + off + sizeof(OpType));
             std::cout << "    [" << i << "] "
                       << "(" << (op == OpType::Insert ? "Insert" : "Delete") << ") "
                       << td.to_string(t)
@@ -166,7 +290,8 @@ public:
 
     // Append an insert operation
     bool insert(const Tuple& t) {
-        const size_t len = td.length(t) + sizeof(OpType);
+        // fixed-width schemas skip the per-insert length walk entirely
+        const size_t len = fixed_layout ? record_stride : td.length(t) + sizeof(OpType);
 
         if (!can_insert(len)) {
             return false;
@@ -178,11 +303,13 @@ public:
         buffer[page_header->heap_end] = static_cast<uint8_t>(OpType::Insert);
         // write tuple immediately after
         td.serialize(buffer + page_header->heap_end + sizeof(OpType), t);
-        // append slot
-        slots[page_header->slot_count] = {
-            static_cast<uint16_t>(page_header->heap_end),
-            static_cast<uint16_t>(len)
-        };
+        if (!fixed_layout) {
+            // append slot; dense offsets are implicit
+            slots[page_header->slot_count] = {
+                static_cast<uint16_t>(page_header->heap_end),
+                static_cast<uint16_t>(len)
+            };
+        }
         ++(page_header->slot_count);
         ++page_header->size;
 
@@ -194,6 +321,7 @@ public:
         if (key > page_header->max_key) {
             page_header->max_key = key;
         }
+        filter_add(key);
         // update to be unsorted
         page_header->meta.isSorted = false;
         return true;
@@ -208,8 +336,10 @@ public:
     }
 
     bool remove(const key_type& key) {
-        // Size calculation for tombstone: OpType + key only
-        const size_t tombstone_len = sizeof(OpType) + sizeof(key_type);
+        // Tombstone carries OpType + key only; the dense layout pads it
+        // to a full stride so offsets stay implicit
+        const size_t tombstone_len =
+            fixed_layout ? record_stride : sizeof(OpType) + sizeof(key_type);
 
         if (!can_insert(tombstone_len)) return false;
 
@@ -219,10 +349,12 @@ public:
         // Write only the key directly after the OpType
         *reinterpret_cast<key_type*>(buffer + page_header->heap_end + sizeof(OpType)) = key;
 
-        slots[page_header->slot_count] = {
-            static_cast<uint16_t>(page_header->heap_end),
-            static_cast<uint16_t>(tombstone_len)
-        };
+        if (!fixed_layout) {
+            slots[page_header->slot_count] = {
+                static_cast<uint16_t>(page_header->heap_end),
+                static_cast<uint16_t>(tombstone_len)
+            };
+        }
 
         --page_header->size;
         ++page_header->slot_count;
@@ -232,8 +364,10 @@ public:
 
     // Append a delete marker
     bool erase(const key_type& key) {
-        // Size calculation for tombstone: OpType + key only
-        const size_t tombstone_len = sizeof(OpType) + sizeof(key_type);
+        // Tombstone carries OpType + key only; padded to a stride in the
+        // dense layout, same as remove()
+        const size_t tombstone_len =
+            fixed_layout ? record_stride : sizeof(OpType) + sizeof(key_type);
 
         if (!can_insert(tombstone_len)) return false;
 
@@ -243,10 +377,12 @@ public:
         // Write only the key directly after the OpType
         *reinterpret_cast<key_type*>(buffer + page_header->heap_end + sizeof(OpType)) = key;
 
-        slots[page_header->slot_count] = {
-            static_cast<uint16_t>(page_header->heap_end),
-            static_cast<uint16_t>(tombstone_len)
-        };
+        if (!fixed_layout) {
+            slots[page_header->slot_count] = {
+                static_cast<uint16_t>(page_header->heap_end),
+                static_cast<uint16_t>(tombstone_len)
+            };
+        }
 
         --page_header->size;
         ++page_header->slot_count;
@@ -259,67 +395,61 @@ public:
 
     // Binary search based on keys in slots (only usable when leaf is sorted!!!)
     uint16_t value_slot(const key_type &key) const {
-        // Binary search if sorted
-        uint16_t left = 0, right = page_header->slot_count;
-        while (left < right) {
-            uint16_t mid = (left + right) / 2;
-            Slot cur = slots[mid];
-            Tuple mid_tuple = td.deserialize(buffer + slots[mid].offset+ sizeof(OpType));
-            if (extract_key(mid_tuple) < key) left = mid + 1;
-            else right = mid;
-        }
-        return left;
+        return static_cast<uint16_t>(sorted_lower_bound(
+            page_header->slot_count, key, [&](size_t i) { return key_at(i); }));
     }
 
     // Find the most recent value for key (or tombstone)
     std::optional<Tuple> get(const key_type& key) const {
+        // a handful of bit probes answers most absent-key lookups before
+        // any slot is touched
+        if (!filter_may_contain(key)) {
+            return std::nullopt;
+        }
 
         // sorted and deduped, no tombstones, O(log n)
         if (page_header->meta.isSorted){
             uint16_t index = value_slot(key);
 
-            if (index < page_header->slot_count) {
-                const Slot &slot = slots[index];
-                Tuple t = td.deserialize(buffer + slot.offset+ sizeof(OpType));
-                if (extract_key(t) == key) {
-                    return t;
-                }
+            if (index < page_header->slot_count && key_at(index) == key &&
+                rec_offset(index) + rec_length(index) <= block_size) {
+                return td.deserialize(buffer + rec_offset(index) + sizeof(OpType));
             }
             return std::nullopt;
         }
 
         // unsorted, O(n)
         for (int i = static_cast<int>(page_header->slot_count) - 1; i >= 0; --i) {
-            const Slot& slot = slots[i];
-            OpType op = static_cast<OpType>(buffer[slot.offset]);
+            const size_t off = rec_offset(i);
+            // torn slot under an optimistic read: skip, validation retries
+            if (off + rec_length(i) > block_size) continue;
+            OpType op = static_cast<OpType>(buffer[off]);
 
             if (op == OpType::Delete) {
-                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + off + sizeof(OpType));
                 if (tombstone_key == key) {
                     // Tombstone with the same key found, return nullopt (key deleted)
                     return std::nullopt;
                 }
                 continue;  // Skip tombstones
             }
-            Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-            if (extract_key(t) == key) {
-                return t;
+            if (key_at(i) == key) {
+                return td.deserialize(buffer + off + sizeof(OpType));
             }
         }
         return std::nullopt;
     }
 
     std::optional<Tuple> get_tuple(size_t i) const {
-        const Slot &slot = slots[i];
-        OpType op = static_cast<OpType>(buffer[slot.offset]);
+        const size_t off = rec_offset(i);
+        OpType op = static_cast<OpType>(buffer[off]);
         // std::unordered_set<key_type> tombstone_keys;
 
         if (op == OpType::Delete) {
-            key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
             // tombstone_keys.insert(tombstone_key);
             return std::nullopt;  // Skip tombstones
         }
-        Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
+        Tuple t = td.deserialize(buffer + off + sizeof(OpType));
         // if (tombstone_keys.contains(extract_key(t)))
         //     return std::nullopt;
         return t;
@@ -331,40 +461,38 @@ public:
             return result;
         if (page_header->meta.isSorted) {
             for (uint16_t i = 0; i < page_header->slot_count; ++i) {
-                const Slot &slot = slots[i];
-                Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
+                key_type k = key_at(i);
                 // sorted data allows early cut
-                if (extract_key(t) < min_key) {
+                if (k < min_key) {
                     continue;
                 }
-                if (extract_key(t) > max_key) {
+                if (k > max_key) {
                     return result;
                 }
-                result.push_back(t);
+                result.push_back(td.deserialize(buffer + rec_offset(i) + sizeof(OpType)));
             }
         }else { // scan
             std::unordered_set<key_type> seen;          // To store keys we've already seen
             std::unordered_set<key_type> tombstones;    // To store keys that have been deleted
 
             for (int i = page_header->slot_count - 1; i >= 0; --i) {
-                const Slot &slot = slots[i];
+                const size_t off = rec_offset(i);
 
-                OpType op = static_cast<OpType>(buffer[slot.offset]);
+                OpType op = static_cast<OpType>(buffer[off]);
                 if (op == OpType::Delete) {
-                    key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
+                    key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + off + sizeof(OpType));
                     tombstones.insert(tombstone_key);
                     continue;
                 }
 
-                Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-                key_type k = extract_key(t);
+                key_type k = key_at(i);
 
                 if (k < min_key || k > max_key) continue;
 
                 if (seen.contains(k) || tombstones.contains(k)) continue;
                 seen.insert(k);
 
-                result.push_back(t);
+                result.push_back(td.deserialize(buffer + off + sizeof(OpType)));
             }
             std::ranges::reverse(result); // maintain sorted order
         }
@@ -377,20 +505,19 @@ public:
         std::unordered_set<key_type> tombstones;
 
         for (int i = page_header->slot_count - 1; i >= 0; --i) {
-            const Slot& slot = slots[i];
-            OpType op = static_cast<OpType>(buffer[slot.offset]);
+            const size_t off = rec_offset(i);
+            OpType op = static_cast<OpType>(buffer[off]);
             if (op == OpType::Delete) {
-                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + off + sizeof(OpType));
                 tombstones.insert(tombstone_key);
                 continue;  // Skip tombstones
             }
 
-            Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-            key_type k = extract_key(t);
+            key_type k = key_at(i);
 
             if (!tombstones.contains(k) && !seen.contains(k)) {
                 tombstones.insert(k);
-                compacted.push_back(t);
+                compacted.push_back(td.deserialize(buffer + off + sizeof(OpType)));
             }
             seen.insert(k);
         }
@@ -398,48 +525,120 @@ public:
         return compacted;
     }
 
-    void sort() {
-        // compact
-        std::vector<Tuple> compacted = compact();
+    // Indices of the newest live record per key (tombstoned and shadowed
+    // versions dropped), oldest first. Works purely on key_at, no tuples.
+    std::vector<uint16_t> live_slots() const {
+        std::vector<uint16_t> live;
+        std::unordered_set<key_type> seen;
+        std::unordered_set<key_type> tombstones;
 
-        // Before re-inserting into old page, clear all records
-        page_header->slot_count = 0;
-        page_header->heap_end = block_size;
-        page_header->size = 0;
-        page_header->min_key = std::numeric_limits<key_type>::max();
-        page_header->max_key = std::numeric_limits<key_type>::min();
+        for (int i = page_header->slot_count - 1; i >= 0; --i) {
+            const size_t off = rec_offset(i);
+            OpType op = static_cast<OpType>(buffer[off]);
+            if (op == OpType::Delete) {
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + off + sizeof(OpType));
+                tombstones.insert(tombstone_key);
+                continue;
+            }
+            key_type k = key_at(i);
+            if (!tombstones.contains(k) && !seen.contains(k)) {
+                tombstones.insert(k);
+                live.push_back(static_cast<uint16_t>(i));
+            }
+            seen.insert(k);
+        }
+        std::ranges::reverse(live);
+        return live;
+    }
+
+    // Copy raw record bytes from another page into this leaf. The record must
+    // carry its OpType prefix; min/max are maintained like insert().
+    void append_raw(const uint8_t* record, uint16_t len, key_type key) {
+        page_header->heap_end -= len;
+        std::memcpy(buffer + page_header->heap_end, record, len);
+        if (!fixed_layout) {
+            slots[page_header->slot_count] = {
+                static_cast<uint16_t>(page_header->heap_end),
+                len
+            };
+        }
+        ++(page_header->slot_count);
+        ++page_header->size;
+        if (key < page_header->min_key) page_header->min_key = key;
+        if (key > page_header->max_key) page_header->max_key = key;
+        filter_add(key);
+    }
 
-        std::sort(compacted.begin(), compacted.end(), [&](const Tuple& a, const Tuple& b) {
-                return extract_key(a) < extract_key(b);
+    // Rewrite the heap so it holds exactly the records in `order` (slot
+    // indices into the current layout), packed from the end of the block.
+    // Records are moved byte-for-byte via a page-sized scratch buffer, so no
+    // Tuple is ever materialized.
+    void rewrite_in_place(const std::vector<uint16_t>& order) {
+        std::array<uint8_t, block_size> scratch;
+        std::vector<Slot> new_slots(order.size());
+
+        key_type new_min = std::numeric_limits<key_type>::max();
+        key_type new_max = std::numeric_limits<key_type>::min();
+        size_t heap = block_size;
+        // the walk already visits every surviving key, so rebuilding the
+        // filter here sheds the bits of records a split or sort dropped
+        filter_clear();
+        for (size_t i = 0; i < order.size(); ++i) {
+            const size_t src_off = rec_offset(order[i]);
+            const size_t src_len = rec_length(order[i]);
+            key_type k = key_at(order[i]);
+            heap -= src_len;
+            std::memcpy(scratch.data() + heap, buffer + src_off, src_len);
+            new_slots[i] = {static_cast<uint16_t>(heap), static_cast<uint16_t>(src_len)};
+            new_min = std::min(new_min, k);
+            new_max = std::max(new_max, k);
+            filter_add(k);
+        }
+
+        std::memcpy(buffer + heap, scratch.data() + heap, block_size - heap);
+        if (!fixed_layout) {
+            std::memcpy(slots, new_slots.data(), new_slots.size() * sizeof(Slot));
+        }
+        page_header->slot_count = order.size();
+        page_header->size = order.size();
+        page_header->heap_end = heap;
+        page_header->min_key = new_min;
+        page_header->max_key = new_max;
+    }
+
+    void sort() {
+        std::vector<uint16_t> live = live_slots();
+        std::sort(live.begin(), live.end(), [&](uint16_t a, uint16_t b) {
+                return key_at(a) < key_at(b);
             });
-        for (size_t i = 0; i < compacted.size(); ++i) insert(compacted[i]);
+        rewrite_in_place(live);
         page_header->meta.isSorted = true;
     }
 
     key_type split_into(LasLeafNode& new_leaf) {
-        // compact
-        std::vector<Tuple> compacted = compact();
-
-        // Before re-inserting into old page, clear all records
-        page_header->slot_count = 0;
-        page_header->heap_end = block_size;
-        page_header->size = 0;
-        page_header->min_key = std::numeric_limits<key_type>::max();
-        page_header->max_key = std::numeric_limits<key_type>::min();
+        std::vector<uint16_t> live = live_slots();
 
         // quick partition by split key
-        size_t idx = compacted.size() * 3 / 4;
-        key_type split_key = extract_key(compacted[idx]);
-
-        for (size_t i = 0; i < compacted.size(); ++i) {
-            Tuple t = compacted[i];
-            key_type key = extract_key(t);
+        std::vector<uint16_t> by_key(live);
+        size_t idx = by_key.size() * 3 / 4;
+        std::nth_element(by_key.begin(), by_key.begin() + idx, by_key.end(),
+                         [&](uint16_t a, uint16_t b) { return key_at(a) < key_at(b); });
+        key_type split_key = key_at(by_key[idx]);
+
+        // move the upper part to the new leaf first (raw byte copies), then
+        // compact the remainder of this page in place
+        std::vector<uint16_t> keep;
+        keep.reserve(live.size());
+        for (uint16_t i: live) {
+            key_type key = key_at(i);
             if (key < split_key) {
-                this->insert(t);
-            }else {
-                new_leaf.insert(t);
+                keep.push_back(i);
+            } else {
+                new_leaf.append_raw(buffer + rec_offset(i),
+                                    static_cast<uint16_t>(rec_length(i)), key);
             }
         }
+        rewrite_in_place(keep);
 
         // restore linked list
         new_leaf.page_header->meta.next_id = page_header->meta.next_id;
@@ -455,16 +654,15 @@ public:
         std::unordered_set<key_type> seen;          // To store keys we've already seen
 
         for (int i = static_cast<int>(page_header->slot_count) - 1; i >= 0; --i) {
-            const Slot& slot = slots[i];
-            OpType op = static_cast<OpType>(buffer[slots[i].offset]);
+            const size_t off = rec_offset(i);
+            OpType op = static_cast<OpType>(buffer[off]);
             if (op == OpType::Delete) {
-                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + slot.offset + sizeof(OpType));
+                key_type tombstone_key = *reinterpret_cast<const key_type*>(buffer + off + sizeof(OpType));
                 deleted.insert(tombstone_key);
                 continue;  // Skip tombstones
             }
 
-            Tuple t = td.deserialize(buffer + slot.offset + sizeof(OpType));
-            key_type k = extract_key(t);
+            key_type k = key_at(i);
             if (seen.contains(k) || deleted.contains(k)) continue;
             new_min = std::min(new_min, k);
             new_max = std::max(new_max, k);
@@ -1,22 +1,32 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+#include <atomic>
 #include <vector>
 #include <thread>
 #include <mutex>
-#include <shared_mutex>
 #include <condition_variable>
 #include <queue>
+#include <list>
+#include <memory>
 #include <iostream>
 #include <unistd.h>
 #include <limits>
 #include <optional>
+#include <span>
 
 #include "BaseFile.hpp"
 #include "NodeTypes.hpp"
 #include "Database.hpp"
 #include "InternalNode.hpp"
 #include "LasLeafNode.hpp"
+#include "SnapshotManager.hpp"
+#include "StatsCounter.hpp"
+#include "TreeScan.hpp"
+#include "WriteAheadLog.hpp"
 #include "Tuple.hpp"
 
 using namespace db;
@@ -39,14 +49,24 @@ public:
     static constexpr uint16_t SPLIT_INTERNAL_POS = internal_t::internal_capacity / 2;
     static constexpr node_id_t INVALID_NODE_ID = std::numeric_limits<node_id_t>::max();
 
+    // A freshly sorted leaf below this fill percentage tries to fold its
+    // right sibling into itself
+    static constexpr size_t MERGE_THRESHOLD_PERCENT = 40;
+
+    // Target leaf fill when bulk-loading from sorted input; the headroom
+    // absorbs some appends before the first splits
+    static constexpr size_t BULK_LOAD_FILL_PERCENT = 90;
+
     // Constructor initializes the tree with an empty root
     explicit LasTree(size_t key_index = 0,
-                            const std::string &name = "", const TupleDesc &td = {})
+                            const std::string &name = "", const TupleDesc &td = {},
+                            size_t sorter_pool_size = 2)
         : BaseFile(name),
           td(td),
           key_index(key_index),
           height(1),
           size(0),
+          num_sorter_threads(sorter_pool_size == 0 ? 1 : sorter_pool_size),
           root_id(INVALID_NODE_ID),
           head_id(INVALID_NODE_ID) {
     }
@@ -56,7 +76,7 @@ public:
 
         // initialize leaf node
         head_id = numPages.fetch_add(1);
-        PageId leaf_pid{filename, head_id};
+        PageId leaf_pid{file_id, head_id};
         // std::cout << "init get_mut_page for "
         //           << " PageId= " << fast_path_leaf_id
         //           << std::endl;
@@ -66,7 +86,7 @@ public:
 
         // Initialize root node (internal node pointing to the leaf)
         root_id = numPages.fetch_add(1);
-        PageId root_pid{filename, root_id};
+        PageId root_pid{file_id, root_id};
         // std::cout << "init get_mut_page for "
         //           << " PageId= " << fast_path_leaf_id
         //           << std::endl;
@@ -76,183 +96,753 @@ public:
         root.children[0] = head_id;
         buffer_pool.unpin_page(root_pid);
 
-        // initialize fast path tracking
-        fast_path_min_key = std::numeric_limits<key_type>::min();
-        fast_path_max_key = std::numeric_limits<key_type>::max();
-        fast_path_leaf_id = head_id;
+        chain_reset({head_id});
+
+        // initialize the calling thread's fast path window; other threads
+        // pick up a window lazily on their first regular-path insert
+        {
+            FastPathWindow &win = my_window();
+            std::lock_guard<std::mutex> lock(win.m);
+            win.leaf_id = head_id;
+            win.min_key = std::numeric_limits<key_type>::min();
+            win.max_key = std::numeric_limits<key_type>::max();
+            win.soft_update_failures = 0;
+        }
 
-        background_sort_thread = std::thread(&LasTree::background_sort_worker, this);
+        for (size_t i = 0; i < num_sorter_threads; ++i) {
+            sorter_threads.emplace_back(&LasTree::background_sort_worker, this);
+        }
     }
 
-    // Destructor ensures background thread is properly terminated
-    ~LasTree() override {
+    /**
+     * Reattach to an existing file instead of building an empty tree:
+     * reads the superblock from page 0, restores the structural state a
+     * descent needs (root, head, height, page count, size) and starts the
+     * sorter pool. The caller must construct the tree with the same schema
+     * and key index the file was written with. Throws when page 0 holds no
+     * valid superblock — a file that was never checkpointed (or died
+     * mid-write) is rebuilt through init() and WAL replay instead.
+     *
+     * The internal levels are faulted into the buffer pool up front: they
+     * are a tiny fraction of the pages but sit on every descent, so a warm
+     * restart skips the per-lookup misses that otherwise dominate the
+     * first minutes of traffic.
+     */
+    void open() {
+        Page sb_page;
+        readPage(sb_page, 0);
+        Superblock sb;
+        std::memcpy(&sb, sb_page.data(), sizeof(sb));
+        if (sb.magic != SUPERBLOCK_MAGIC || sb.checksum != superblock_checksum(sb)) {
+            throw std::runtime_error("open: no valid superblock in " + filename);
+        }
+
+        root_id = sb.root_id;
+        head_id = sb.head_id;
+        height = sb.height;
+        // The buffer pool keeps flushing lazily after a checkpoint, so a
+        // crash can leave pages past sb.num_pages on disk — including
+        // internal nodes that reference them. Allocating from the file's
+        // real extent keeps new page ids from colliding with those; WAL
+        // replay re-covers whatever they held.
+        numPages.store(std::max<size_t>(sb.num_pages, getNumPages()));
+        size.store(sb.size);
+
+        // fast-path windows stay invalid; each thread re-adopts a leaf on
+        // its first insert, as windows carry no durable meaning
+        warm_internal_levels();
+
+        for (size_t i = 0; i < num_sorter_threads; ++i) {
+            sorter_threads.emplace_back(&LasTree::background_sort_worker, this);
+        }
+    }
+
+    /**
+     * Make the on-disk tree reopenable: push this file's dirty pages out,
+     * make them durable, then publish a superblock pointing at them. The
+     * superblock is a single page write after the data sync, so a crash at
+     * any point leaves either the old consistent superblock or the new one.
+     */
+    void checkpoint() override {
+        getDatabase().getBufferPool().flushFile(filename);
+        fdatasync(fd);
+
+        Superblock sb{};
+        sb.magic = SUPERBLOCK_MAGIC;
+        sb.num_pages = numPages.load();
+        sb.size = size.load();
+        sb.root_id = root_id;
+        sb.head_id = head_id;
+        sb.height = height;
+        sb.checksum = superblock_checksum(sb);
+
+        Page sb_page{};
+        std::memcpy(sb_page.data(), &sb, sizeof(sb));
+        writePage(sb_page, 0);
+        fdatasync(fd);
+    }
+
+    // Stop and join the sorter pool; safe to call more than once
+    void stop_background() override {
         {
             std::lock_guard<std::mutex> lock(queue_mutex);
             stop_background_thread = true;
         }
-        close(fd);
         cold_nodes_cv.notify_all();
-        if (background_sort_thread.joinable()) {
-            background_sort_thread.join();
+        for (std::thread &t: sorter_threads) {
+            if (t.joinable()) {
+                t.join();
+            }
         }
     }
 
+    // Destructor ensures background threads are properly terminated
+    ~LasTree() override {
+        stop_background();
+        close(fd);
+    }
+
     // Insert a tuple into the tree
     void insert(const Tuple &tuple) override {
+        record_op(TraceOp::INSERT, tuple.get_field(key_index));
+        insert_impl(tuple);
+        wal_log(WriteAheadLog::RecordType::INSERT, tuple);
+    }
+
+    // Unlogged core of insert(). The fast-path and batch internals re-enter
+    // through this so each public mutation logs exactly one redo record.
+    void insert_impl(const Tuple &tuple) {
         BufferPool &buffer_pool = getDatabase().getBufferPool();
         key_type key = std::get<key_type>(tuple.get_field(key_index));
 
         // std::cout << "inserting " << key << std::endl;
 
-        // try fast path insertion if key is in the current fast path range
-        if (can_use_fast_path(key)) {
+        // try fast path insertion if key is in this thread's window
+        bool try_fast;
+        {
+            FastPathWindow &win = my_window();
+            std::lock_guard<std::mutex> lock(win.m);
+            try_fast = win.covers(key);
+        }
+        if (try_fast) {
             insert_fast_path(tuple, key);
             return;
         }
+        fast_path_misses.inc();
 
         // Regular path insertion
         path_t path;
         key_type next_leaf_min_key;
         node_id_t leaf_id = find_path_to_node(path, key, next_leaf_min_key);
 
-        PageId leaf_pid{filename, leaf_id};
-        std::unique_lock<std::shared_mutex> lock(get_leaf_rwlock(leaf_id));
-        Page &page = buffer_pool.get_mut_page(leaf_pid);
-        leaf_t leaf(page, td, key_index);
-
-        if (leaf.insert(tuple)) {
-            buffer_pool.mark_dirty(leaf_pid);
-            size++;
-            buffer_pool.unpin_page(leaf_pid);
+        bool inserted = false;
+        bool updated = false;
+        node_id_t original_fast_path = INVALID_NODE_ID;
+        while (true) {
+            PageId leaf_pid{file_id, leaf_id};
+            Page &page = buffer_pool.get_mut_page(leaf_pid);
+            leaf_t leaf(page, td, key_index);
 
-            bool updated = false;
-            node_id_t original_fast_path = fast_path_leaf_id;
-            // if inserted into right of fast path, soft update path to next id
-            if (key == fast_path_max_key + 1) {
-                fast_path_leaf_id = leaf_id;
-                fast_path_min_key = leaf.min_key();
-                node_id_t next_id = leaf.page_header->meta.next_id;
-                if (next_id == INVALID_NODE_ID) {
-                    fast_path_max_key = std::numeric_limits<key_type>::max();
+            node_id_t hop_to = INVALID_NODE_ID;
+            bool restart = false;
+            {
+                OptimisticWriteGuard guard(buffer_pool.page_latch(leaf_pid),
+                                           &leaf_latch_contention.value);
+                // A merge that raced our descent absorbed this leaf into
+                // its left sibling; anything written here would be lost.
+                if (leaf.page_header->meta.isDead) {
+                    restart = true;
                 } else {
-                    fast_path_max_key = next_leaf_min_key - 1;
-                }
-                updated = true;
-            }else {
-                ++soft_update_failures;
-                if (soft_update_failures >= MAX_SOFT_FAILS) {
-                    // hard reset fast path to current leaf
-                    fast_path_leaf_id = leaf_id;
-                    fast_path_min_key = leaf.min_key();
+                    // A split that raced our descent has moved the upper
+                    // part of this leaf's range to a right sibling; the
+                    // sibling's current minimum is exactly the split fence,
+                    // so the true upper bound is the smaller of it and the
+                    // parent's fence.
                     node_id_t next_id = leaf.page_header->meta.next_id;
-                    if (next_id == INVALID_NODE_ID) {
-                        fast_path_max_key = std::numeric_limits<key_type>::max();
+                    key_type upper_fence = std::numeric_limits<key_type>::max();
+                    if (next_id != INVALID_NODE_ID) {
+                        upper_fence = std::min(next_leaf_min_key, sibling_min_key(next_id));
+                    }
+                    if (key >= upper_fence) {
+                        // follow the leaf chain instead of re-descending:
+                        // the parent may not carry the new separator yet
+                        hop_to = next_id;
                     } else {
-                        fast_path_max_key = next_leaf_min_key - 1;
+                        snapshots.copy_on_write(leaf_id, page);
+                        inserted = leaf.insert(tuple);
+                        if (inserted) {
+                            buffer_pool.mark_dirty(leaf_pid);
+
+                            // Window update stays inside the latch so a
+                            // concurrent split cannot miss clamping a
+                            // window we have not published yet.
+                            FastPathWindow &win = my_window();
+                            std::lock_guard<std::mutex> lock(win.m);
+                            original_fast_path = win.leaf_id;
+                            bool adopt = false;
+                            // inserted right of the window: soft-advance it
+                            if (win.leaf_id != INVALID_NODE_ID && key == win.max_key + 1) {
+                                adopt = true;
+                            } else {
+                                ++win.soft_update_failures;
+                                if (win.soft_update_failures >= MAX_SOFT_FAILS) {
+                                    // hard reset window to the current leaf
+                                    adopt = true;
+                                    win.soft_update_failures = 0;
+                                    window_hard_resets.inc();
+                                }
+                            }
+                            if (adopt) {
+                                win.leaf_id = leaf_id;
+                                win.min_key = leaf.min_key();
+                                win.max_key = (next_id == INVALID_NODE_ID)
+                                                  ? std::numeric_limits<key_type>::max()
+                                                  : upper_fence - 1;
+                                updated = true;
+                            }
+                        }
                     }
-                    soft_update_failures = 0;
-                    updated = true;
                 }
             }
+            buffer_pool.unpin_page(leaf_pid);
+            if (restart) {
+                path.clear();
+                leaf_id = find_path_to_node(path, key, next_leaf_min_key);
+                continue;
+            }
+            if (hop_to == INVALID_NODE_ID) break;
+            leaf_id = hop_to;
+        }
+
+        if (inserted) {
+            size++;
+            if (updated && original_fast_path != leaf_id) {
+                // hand the leaf this window left to the sorter pool
+                maybe_enqueue_cold(original_fast_path);
+            }
+            return;
+        }
+
+        insert_into_leaf(tuple);
+        size++;
+    }
+
+    /**
+     * Batched insert: sorts the batch by key (stable, so duplicates keep
+     * their batch order) and groups runs of keys that land in the same leaf.
+     * Each group pays one root-to-leaf descent, one leaf latch and one
+     * mark_dirty/unpin_page instead of one per tuple, which is the dominant
+     * cost for loaders pushing near-sorted batches.
+     */
+    void insert_batch(std::span<const Tuple> tuples) override {
+        if (tuples.empty()) return;
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
 
-            if (updated) {
-                // add to cold queue
+        std::vector<size_t> order(tuples.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return std::get<key_type>(tuples[a].get_field(key_index)) <
+                   std::get<key_type>(tuples[b].get_field(key_index));
+        });
+
+        size_t i = 0;
+        while (i < order.size()) {
+            size_t group_start = i;
+            key_type key = std::get<key_type>(tuples[order[i]].get_field(key_index));
+            path_t path;
+            key_type next_leaf_min_key;
+            node_id_t leaf_id = find_path_to_node(path, key, next_leaf_min_key);
+
+            PageId leaf_pid{file_id, leaf_id};
+            key_type upper_fence = std::numeric_limits<key_type>::max();
+            bool dead = false;
+            {
+                Page &page = buffer_pool.get_mut_page(leaf_pid);
+                leaf_t leaf(page, td, key_index);
+                bool dirtied = false;
                 {
-                    std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
-                    if (cold_node_set.insert(original_fast_path).second) {
-                        std::lock_guard<std::mutex> queue_lock(queue_mutex);
-                        cold_nodes_queue.push(original_fast_path);
-                        // std::cout << "[Thread " << std::this_thread::get_id() << "[BG_QUEUE] Enqueued cold node ID: " << original_fast_path << std::endl;
-                        cold_nodes_cv.notify_one();
+                    OptimisticWriteGuard guard(buffer_pool.page_latch(leaf_pid),
+                                               &leaf_latch_contention.value);
+                    // a racing merge absorbed this leaf: re-descend
+                    dead = leaf.page_header->meta.isDead;
+                    // Re-derive the upper bound under the latch: a split
+                    // that raced the descent leaves the parent's fence too
+                    // high, but the right sibling's minimum is the fence.
+                    node_id_t next_id = leaf.page_header->meta.next_id;
+                    if (!dead && next_id != INVALID_NODE_ID) {
+                        upper_fence = std::min(next_leaf_min_key, sibling_min_key(next_id));
+                    }
+                    // Keys are sorted, so everything below the leaf's upper
+                    // bound belongs here; stop at the boundary or when the
+                    // leaf fills.
+                    while (!dead && i < order.size()) {
+                        key = std::get<key_type>(tuples[order[i]].get_field(key_index));
+                        if (key >= upper_fence) break;
+                        if (!dirtied) snapshots.copy_on_write(leaf_id, page);
+                        if (!leaf.insert(tuples[order[i]])) break;
+                        dirtied = true;
+                        ++size;
+                        ++i;
                     }
+                    if (dirtied) buffer_pool.mark_dirty(leaf_pid);
                 }
+                buffer_pool.unpin_page(leaf_pid);
+            }
+            if (dead) continue;
+
+            // If the next tuple still belongs to this leaf the page is full
+            // (or the key hit the rightmost boundary sentinel): push it
+            // through the regular insert path, which splits, then resume
+            // grouping with a fresh descent.
+            if (i < order.size() && (key < upper_fence || i == group_start)) {
+                insert_impl(tuples[order[i]]);
+                ++i;
             }
-            return;
         }
-        buffer_pool.unpin_page(leaf_pid);
 
-        insert_into_leaf(leaf_pid, tuple, path, next_leaf_min_key);
-        size++;
+        // one redo record per tuple, one sync for the whole batch
+        wal_log_batch(tuples);
+    }
+
+    /**
+     * Bulk-load a fresh tree from tuples already sorted by key. Leaves are
+     * written left-to-right at BULK_LOAD_FILL_PERCENT and linked as they
+     * go, then internal levels are packed bottom-up, so none of the
+     * incremental split machinery runs. Only valid on an empty, quiescent
+     * tree; the initial leaf from init() is abandoned.
+     */
+    template<typename InputIt>
+    void bulk_load(InputIt begin, InputIt end) {
+        if (size != 0) {
+            throw std::runtime_error("bulk_load: tree is not empty");
+        }
+        if (begin == end) return;
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        std::lock_guard<std::mutex> structure_lock(structure_mutex);
+
+        const size_t target_bytes =
+            leaf_t::available_space * BULK_LOAD_FILL_PERCENT / 100;
+
+        // 1. leaves, left to right, linked as they are produced
+        std::vector<node_id_t> leaf_ids;
+        std::vector<key_type> leaf_first_keys;
+        std::vector<key_type> leaf_last_keys;
+        size_t count = 0;
+        for (InputIt it = begin; it != end;) {
+            node_id_t id = numPages.fetch_add(1);
+            PageId pid{file_id, id};
+            leaf_t leaf(buffer_pool.get_mut_page(pid), td, key_index, id,
+                        INVALID_NODE_ID, false);
+            buffer_pool.mark_dirty(pid);
+
+            leaf_first_keys.push_back(std::get<key_type>((*it).get_field(key_index)));
+            while (it != end && leaf.used_space() < target_bytes) {
+                if (!leaf.insert(*it)) break;
+                ++count;
+                ++it;
+            }
+            // appended in key order with no tombstones, so the page is sorted
+            leaf.page_header->meta.isSorted = true;
+            leaf_last_keys.push_back(leaf.max_key());
+            buffer_pool.unpin_page(pid);
+
+            if (!leaf_ids.empty()) {
+                PageId prev_pid{file_id, leaf_ids.back()};
+                leaf_t prev(buffer_pool.get_mut_page(prev_pid), td, key_index);
+                prev.page_header->meta.next_id = id;
+                buffer_pool.mark_dirty(prev_pid);
+                buffer_pool.unpin_page(prev_pid);
+            }
+            leaf_ids.push_back(id);
+        }
+
+        // 2. internal levels, bottom-up; seps[j] separates child j and
+        // j+1, suffix-truncated against the last key of the left leaf
+        std::vector<node_id_t> level = leaf_ids;
+        std::vector<key_type> seps;
+        seps.reserve(leaf_ids.size() > 0 ? leaf_ids.size() - 1 : 0);
+        for (size_t j = 1; j < leaf_ids.size(); ++j) {
+            seps.push_back(truncate_separator(leaf_last_keys[j - 1], leaf_first_keys[j]));
+        }
+        uint8_t new_height = 1;
+        while (level.size() > static_cast<size_t>(internal_t::internal_capacity) + 1) {
+            std::vector<node_id_t> parents;
+            std::vector<key_type> parent_seps;
+            size_t i = 0;
+            while (i < level.size()) {
+                size_t remaining = level.size() - i;
+                size_t take = std::min<size_t>(internal_t::internal_capacity + 1, remaining);
+                if (remaining - take == 1) --take; // never leave a childless node
+
+                node_id_t nid = numPages.fetch_add(1);
+                PageId npid{file_id, nid};
+                internal_t node(buffer_pool.get_mut_page(npid), nid);
+                buffer_pool.mark_dirty(npid);
+                node.header->size = static_cast<uint16_t>(take - 1);
+                for (size_t c = 0; c < take; ++c) {
+                    node.children[c] = level[i + c];
+                }
+                for (size_t k = 0; k + 1 < take; ++k) {
+                    node.keys[k] = seps[i + k];
+                }
+                buffer_pool.unpin_page(npid);
+
+                if (!parents.empty()) {
+                    parent_seps.push_back(seps[i - 1]);
+                }
+                parents.push_back(nid);
+                i += take;
+            }
+            level = std::move(parents);
+            seps = std::move(parent_seps);
+            ++new_height;
+        }
+
+        // 3. the remaining level fits in the existing root page
+        PageId root_pid{file_id, root_id};
+        internal_t root(buffer_pool.get_mut_page(root_pid), root_id);
+        buffer_pool.mark_dirty(root_pid);
+        root.header->size = static_cast<uint16_t>(level.size() - 1);
+        for (size_t c = 0; c < level.size(); ++c) {
+            root.children[c] = level[c];
+        }
+        for (size_t k = 0; k + 1 < level.size(); ++k) {
+            root.keys[k] = seps[k];
+        }
+        buffer_pool.unpin_page(root_pid);
+
+        head_id = leaf_ids.front();
+        height = new_height;
+        size = count;
+        chain_reset(leaf_ids);
+
+        // point this thread's window at the rightmost leaf for appends
+        {
+            FastPathWindow &win = my_window();
+            std::lock_guard<std::mutex> lock(win.m);
+            win.leaf_id = leaf_ids.back();
+            win.min_key = leaf_first_keys.back();
+            win.max_key = std::numeric_limits<key_type>::max();
+            win.soft_update_failures = 0;
+        }
     }
 
     std::optional<db::Tuple> get(const field_t &key) override {
+        record_op(TraceOp::GET, key);
         BufferPool &buffer_pool = getDatabase().getBufferPool();
         key_type actual_key = std::get<key_type>(key);
 
         path_t _;
-        key_type __;
         node_id_t leaf_id = find_leaf(_, actual_key);
 
-        PageId pid{filename, leaf_id};
-        std::shared_lock<std::shared_mutex> lock(get_leaf_rwlock(leaf_id));  // shared read
+        // The descent is latch-free, so a split or merge can commit between
+        // the last parent validation and the leaf read. Like the writer path
+        // in insert_impl: a dead leaf means a merge absorbed it (its copy of
+        // the key may be stale), so redo the descent; a missing key with the
+        // right sibling's minimum at or below it means a split moved the
+        // upper half out, so follow the leaf chain.
+        std::optional<Tuple> opt_tuple;
+        for (;;) {
+            PageId pid{file_id, leaf_id};
+            Page &page = buffer_pool.get_mut_page(pid);
+            OptimisticLatch &latch = buffer_pool.page_latch(pid);
+
+            // Optimistic read: no lock taken, just validate the frame
+            // version afterwards and redo the lookup if a writer got in
+            // between.
+            bool sorted, dead;
+            node_id_t next_id;
+            for (;;) {
+                uint64_t version = latch.read_begin();
+                leaf_t leaf(page, td, key_index);
+                dead = leaf.page_header->meta.isDead;
+                next_id = leaf.page_header->meta.next_id;
+                sorted = leaf.is_sorted();
+                opt_tuple = leaf.get(actual_key);
+                if (latch.read_validate(version)) break;
+            }
+            buffer_pool.unpin_page(pid);
 
-        // std::cout << "get tuple get_mut_page for "
-        //           << " PageId= " << leaf_id
-        //           << std::endl;
-        Page &page = buffer_pool.get_mut_page(pid);
-        leaf_t leaf(page, td, key_index);
-        if (leaf.is_sorted()) {
-            ++sorted_leaf_search;
+            if (dead) {
+                path_t path;
+                leaf_id = find_leaf(path, actual_key);
+                continue;
+            }
+            // A hit is authoritative — a split never leaves the key behind —
+            // so the sibling probe only costs lookups that miss at a fence.
+            if (!opt_tuple.has_value() && next_id != INVALID_NODE_ID &&
+                actual_key >= sibling_min_key(next_id)) {
+                leaf_id = next_id;
+                continue;
+            }
+            if (sorted) {
+                ++sorted_leaf_search;
+            } else {
+                note_unsorted_read(leaf_id);
+            }
+            break;
         }
-        std::optional<Tuple> opt_tuple = leaf.get(actual_key);
-        buffer_pool.unpin_page(pid);
         return opt_tuple;
     }
 
+    /**
+     * Batched point lookups. The keys are probed in sorted order so keys
+     * that share a leaf cost one descent, one pin and one latch validation
+     * between them instead of one each; serving-tier batches of co-located
+     * keys collapse to a handful of descents. The sink is invoked once per
+     * key, in sorted key order, with the key's index in the input span and
+     * the lookup result; results match what per-key get() calls racing the
+     * same writers could have returned.
+     */
+    template<typename Sink>
+    void multi_get(std::span<const key_type> keys, Sink &&sink) {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+
+        std::vector<size_t> order(keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(),
+                  [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        size_t i = 0;
+        while (i < order.size()) {
+            path_t _;
+            node_id_t leaf_id = find_leaf(_, keys[order[i]]);
+
+            std::vector<std::optional<Tuple>> results;
+            size_t probed;
+            for (;;) {
+                PageId pid{file_id, leaf_id};
+                Page &page = buffer_pool.get_mut_page(pid);
+                OptimisticLatch &latch = buffer_pool.page_latch(pid);
+
+                // Optimistic read, like get(): probe every batch key the
+                // leaf can answer under one version check, redo the group
+                // if a writer got in between. The first key is probed
+                // unconditionally so each descent always makes progress;
+                // keys past the leaf's max get their own descent, which
+                // also covers keys falling in the gap before the next
+                // leaf's range.
+                bool sorted, dead;
+                node_id_t next_id;
+                for (;;) {
+                    uint64_t version = latch.read_begin();
+                    results.clear();
+                    probed = 0;
+                    leaf_t leaf(page, td, key_index);
+                    dead = leaf.page_header->meta.isDead;
+                    next_id = leaf.page_header->meta.next_id;
+                    sorted = leaf.is_sorted();
+                    key_type leaf_max = leaf.max_key();
+                    while (i + probed < order.size()) {
+                        const key_type &key = keys[order[i + probed]];
+                        if (probed > 0 && key > leaf_max) break;
+                        results.push_back(leaf.get(key));
+                        ++probed;
+                    }
+                    if (latch.read_validate(version)) break;
+                }
+                buffer_pool.unpin_page(pid);
+
+                // Same fence handling as get(): the break-on-leaf_max guard
+                // above never covers the group's first key, so a split that
+                // raced the descent could leave it probing the stale left
+                // half. Redo a merged-away leaf from the root, hop a moved
+                // first key along the chain.
+                if (dead) {
+                    path_t path;
+                    leaf_id = find_leaf(path, keys[order[i]]);
+                    continue;
+                }
+                if (!results[0].has_value() && next_id != INVALID_NODE_ID &&
+                    keys[order[i]] >= sibling_min_key(next_id)) {
+                    leaf_id = next_id;
+                    continue;
+                }
+                if (sorted) {
+                    sorted_leaf_search += probed;
+                } else {
+                    // one temperature tick per batch touching the leaf, not
+                    // per key: a batch is one read burst, not `probed`
+                    // readers
+                    note_unsorted_read(leaf_id);
+                }
+                break;
+            }
+
+            for (size_t r = 0; r < probed; ++r) {
+                sink(order[i + r], std::move(results[r]));
+            }
+            i += probed;
+        }
+    }
+
+    // Convenience form of multi_get: results aligned with the input keys.
+    std::vector<std::optional<Tuple>> multi_get(std::span<const key_type> keys) {
+        std::vector<std::optional<Tuple>> out(keys.size());
+        multi_get(keys, [&](size_t idx, std::optional<Tuple> t) {
+            out[idx] = std::move(t);
+        });
+        return out;
+    }
 
     // Update an existing key with a new value
     bool update(const key_type &key, const std::vector<std::pair<size_t, db::field_t> > &updates) {
-        BufferPool &buffer_pool = getDatabase().getBufferPool();
-        path_t path;
-        node_id_t leaf_id = find_leaf(path, key);
+        std::optional<Tuple> applied = update_core(key, [&](const Tuple &current) {
+            Tuple updated = current;
+            for (const auto &[idx, val]: updates) {
+                updated.set_field(idx, val);
+            }
+            return updated;
+        });
+        if (applied.has_value()) {
+            wal_log(WriteAheadLog::RecordType::UPDATE, *applied);
+        }
+        return applied.has_value();
+    }
 
-        PageId leaf_pid{filename, leaf_id};
-        // std::cout << "update get_mut_page for "
-        //           << " PageId= " << leaf_id
-        //           << std::endl;
-        Page &leaf_page = buffer_pool.get_mut_page(leaf_pid);
-        leaf_t leaf(leaf_page, td, key_index);
-        buffer_pool.mark_dirty(leaf_pid);
+    // BaseFile update entry: replace the stored tuple carrying t's key.
+    // WAL replay re-applies UPDATE records through this path.
+    bool update(const Tuple &t) override {
+        record_op(TraceOp::UPDATE, t.get_field(key_index));
+        key_type key = std::get<key_type>(t.get_field(key_index));
+        std::optional<Tuple> applied = update_core(key, [&](const Tuple &) { return t; });
+        if (applied.has_value()) {
+            wal_log(WriteAheadLog::RecordType::UPDATE, t);
+        }
+        return applied.has_value();
+    }
+
+    std::vector<Tuple> range(const field_t &min_key, const field_t &max_key) override {
+        return range_scan(std::get<key_type>(min_key), std::get<key_type>(max_key));
+    }
 
-        auto opt = leaf.get(key);
-        if (!opt.has_value()) return false;
+    /**
+     * Parallel fan-out variant of range() for scans large enough that one
+     * thread walking the leaf chain caps bandwidth at a single core. The
+     * separator keys in the upper internal levels cut [min_key, max_key]
+     * into contiguous sub-ranges; each worker runs the same leaf-chain
+     * scan (with its own readahead) over one sub-range, and because the
+     * sub-ranges are disjoint and in key order the merge is concatenation.
+     * Ordering within unsorted leaves matches range(): insertion order
+     * until the background sorter reaches them.
+     */
+    std::vector<Tuple> parallel_range(const field_t &min_key, const field_t &max_key,
+                                      size_t num_threads = std::thread::hardware_concurrency()) {
+        key_type lo = std::get<key_type>(min_key);
+        key_type hi = std::get<key_type>(max_key);
+        if (num_threads <= 1) {
+            return range_scan(lo, hi);
+        }
 
-        db::Tuple updated = opt.value();
+        std::vector<key_type> bounds = collect_partition_bounds(lo, hi, num_threads);
+        if (bounds.empty()) {
+            // tree too small to cut up; not worth the threads either
+            return range_scan(lo, hi);
+        }
 
-        for (const auto &[idx, val]: updates) {
-            updated.set_field(idx, val);
+        // sub-range r covers [starts, ends] inclusive; bounds[r] is the
+        // first key of sub-range r+1
+        size_t parts = bounds.size() + 1;
+        std::vector<std::vector<Tuple>> partial(parts);
+        std::vector<std::thread> workers;
+        workers.reserve(parts);
+        for (size_t r = 0; r < parts; ++r) {
+            key_type sub_lo = (r == 0) ? lo : bounds[r - 1];
+            key_type sub_hi = (r + 1 == parts) ? hi : bounds[r] - 1;
+            workers.emplace_back([this, r, sub_lo, sub_hi, &partial] {
+                partial[r] = range_scan(sub_lo, sub_hi);
+            });
+        }
+        for (std::thread &w: workers) {
+            w.join();
         }
 
-        bool result = leaf.update(updated);
-        buffer_pool.unpin_page(leaf_pid);
+        size_t total = 0;
+        for (const std::vector<Tuple> &p: partial) {
+            total += p.size();
+        }
+        std::vector<Tuple> result;
+        result.reserve(total);
+        for (std::vector<Tuple> &p: partial) {
+            result.insert(result.end(), std::make_move_iterator(p.begin()),
+                          std::make_move_iterator(p.end()));
+        }
         return result;
     }
 
-    std::vector<Tuple> range(const field_t &min_key, const field_t &max_key) override {
+    /**
+     * Snapshot-consistent variant of range(): the scan observes the tree
+     * exactly as it stood when the call began, regardless of concurrent
+     * inserts, sorts, splits and merges, and takes no leaf latches. A
+     * SnapshotManager epoch is pinned for the duration; writers copy each
+     * leaf aside before their first modification in the epoch window, and
+     * the scan reads those copies where they exist and the live page where
+     * they do not (see SnapshotManager for the race-free protocol). Leaves
+     * created by post-snapshot splits are skipped by following the copied
+     * chain, and a descent that lands on one is redirected to the leaf it
+     * was split out of. Internal nodes are not versioned — any descent
+     * finds some leaf whose snapshot range covers the key, which is all
+     * the chain walk needs.
+     */
+    std::vector<Tuple> snapshot_range(const field_t &min_key, const field_t &max_key) {
         BufferPool &buffer_pool = getDatabase().getBufferPool();
-        path_t path;
+        key_type lo = std::get<key_type>(min_key);
+        key_type hi = std::get<key_type>(max_key);
+        SnapshotManager::Guard snap(snapshots);
         std::vector<Tuple> result;
 
-        key_type actual_min_key = std::get<key_type>(min_key);
-        key_type actual_max_key = std::get<key_type>(max_key);
-        node_id_t leaf_id = find_leaf(path, actual_min_key);
+        path_t path;
+        node_id_t leaf_id = find_leaf(path, lo);
+        // the live descent may land on a leaf born after the snapshot;
+        // back up to the snapshot-era leaf covering the same range
+        while (auto origin = snapshots.origin_of(leaf_id, snap.epoch())) {
+            leaf_id = static_cast<node_id_t>(*origin);
+        }
+
         while (leaf_id != INVALID_NODE_ID) {
-            PageId page_id{filename, leaf_id};
-            Page &page = buffer_pool.get_mut_page(page_id);
-            leaf_t leaf(page, td, key_index);
-            std::vector<Tuple> rangeTuples = leaf.get_range(actual_min_key, actual_max_key);
-            if (rangeTuples.empty()) {
+            node_id_t next_id;
+            std::vector<Tuple> rangeTuples;
+
+            Page *copy = snapshots.read(leaf_id, snap.epoch());
+            if (copy == nullptr) {
+                PageId page_id{file_id, leaf_id};
+                Page &page = buffer_pool.get_mut_page(page_id);
+                leaf_t leaf(page, td, key_index);
+                next_id = leaf.page_header->meta.next_id;
+                rangeTuples = leaf.get_range(lo, hi);
                 buffer_pool.unpin_page(page_id);
+                // a writer may have raced the live read; its copy of the
+                // pre-write page is published before the first store, so
+                // if one shows up now, redo this leaf from the copy
+                copy = snapshots.read(leaf_id, snap.epoch());
+            }
+            if (copy != nullptr) {
+                leaf_t leaf(*copy, td, key_index);
+                next_id = leaf.page_header->meta.next_id;
+                rangeTuples = leaf.get_range(lo, hi);
+            }
+
+            if (rangeTuples.empty()) {
                 return result;
             }
             result.insert(result.end(), rangeTuples.begin(), rangeTuples.end());
-
-            buffer_pool.unpin_page(page_id);
-            leaf_id = leaf.page_header->meta.next_id;
+            leaf_id = next_id;
         }
         return result;
     }
 
+    using scan_t = TreeScan<leaf_t, key_type>;
+
+    // Streaming alternative to range(): returns a cursor pinning one leaf
+    // at a time, so a long scan never holds more than one leaf's tuples
+    // in memory. Like range(), it does not take leaf latches; scans racing
+    // the background sorter should use range() on sorted data instead.
+    scan_t scan(const key_type &min_key, const key_type &max_key) {
+        path_t path;
+        node_id_t leaf_id = find_leaf(path, min_key);
+        return scan_t(file_id, leaf_id, td, key_index, min_key, max_key);
+    }
+
 
     // Check if a key exists in the tree
     bool contains(const key_type &key) const {
@@ -273,7 +863,7 @@ public:
         node_id_t curr_id = head_id;
         while (curr_id != INVALID_NODE_ID) {
             // fetch from buffer pool and construct
-            PageId page_id{filename, curr_id};
+            PageId page_id{file_id, curr_id};
             Page &page = buffer_pool.get_mut_page(page_id);
             leaf_t node(page, td, key_index);
 
@@ -311,13 +901,17 @@ public:
 
             // extra info
             std::cout << (node.is_sorted() ? "sorted" : "unsorted");
-            if (curr_id == fast_path_leaf_id) std::cout << " (fast path)";
+            if (is_fast_path_leaf(curr_id)) std::cout << " (fast path)";
             std::cout << std::endl;
             buffer_pool.unpin_page(page_id);
             curr_id = node.page_header->meta.next_id;
         }
     }
 
+    const TupleDesc &getTupleDesc() const override {
+        return td;
+    }
+
     // Get the number of elements in the tree
     size_t get_size() const {
         return size;
@@ -333,37 +927,103 @@ public:
         return fast_path_hits;
     }
 
+    // Snapshot of the live leaf ids in key order, taken from the in-memory
+    // sibling index — no page reads. Splits and merges racing the snapshot
+    // may be missing from it, which is fine for stats and scheduling.
+    std::vector<node_id_t> leaf_chain() const {
+        std::lock_guard<std::mutex> lock(chain_mutex);
+        return {leaf_chain_list.begin(), leaf_chain_list.end()};
+    }
+
+    // Number of live leaves, O(1) from the sibling index.
+    size_t leaf_count() const {
+        std::lock_guard<std::mutex> lock(chain_mutex);
+        return leaf_chain_list.size();
+    }
+
     std::pair<size_t, double> get_leaf_stats() const {
-        size_t leaf_count = 0;
         size_t total_used = 0;
         size_t total_available = 0;
 
-        node_id_t curr = head_id;
         auto &buffer_pool = getDatabase().getBufferPool();
 
-
-        // buffer_pool.pin_page(pid);
-        while (curr != INVALID_NODE_ID) {
-            PageId pid{filename, curr};
+        // iterate the sibling index instead of chasing next_id through the
+        // pool: the page fetches no longer depend on each other, so the
+        // next leaf can stream in while the current one is measured
+        std::vector<node_id_t> chain = leaf_chain();
+        for (size_t i = 0; i < chain.size(); ++i) {
+            if (i + 1 < chain.size()) {
+                prefetchPages(chain[i + 1], 1);
+            }
+            PageId pid{file_id, chain[i]};
             Page &page = buffer_pool.get_mut_page(pid);
             leaf_t leaf(page, td, key_index);
 
-            ++leaf_count;
             total_used += leaf.used_space();
             total_available += leaf_t::available_space;
-
-            curr = leaf.page_header->meta.next_id;
             buffer_pool.unpin_page(pid);
         }
 
-
         double utilization = (total_available > 0) ? (double)total_used / total_available : 0.0;
-        return {leaf_count, utilization};
+        return {chain.size(), utilization};
     }
     size_t get_sorted_leaf_search() const {
         return sorted_leaf_search;
     }
 
+    // Backpressure stats for the sorter pool: how many cold nodes are
+    // waiting right now, and how far the pool trails the enqueue count.
+    size_t get_sort_queue_depth() const {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        return cold_nodes_queue.size();
+    }
+
+    size_t get_sort_lag() const {
+        size_t enqueued = cold_nodes_enqueued.load();
+        size_t done = bg_sort_count.load();
+        return enqueued > done ? enqueued - done : 0;
+    }
+
+    size_t get_leaf_merge_count() const {
+        return leaf_merge_count.load();
+    }
+
+    // Plain-value snapshot of the tree's hot-path counters. Each field is
+    // read relaxed, so the snapshot is cheap but not a consistent cut —
+    // fine for the monitoring it exists for. leaf_latch_contention counts
+    // leaf-latch acquisitions that had to wait out another writer (the
+    // latches are word-sized version latches, so contended acquisitions
+    // rather than wait time is the cheap always-on signal).
+    struct TreeStats {
+        size_t size;
+        size_t fast_path_hits;
+        size_t fast_path_misses;
+        size_t window_hard_resets;
+        size_t leaf_splits;
+        size_t leaf_merges;
+        size_t bg_sorts;
+        size_t sorted_leaf_searches;
+        size_t sort_queue_depth;
+        size_t sort_lag;
+        size_t leaf_latch_contention;
+    };
+
+    TreeStats get_stats() const {
+        return {
+            size.load(),
+            fast_path_hits.load(),
+            fast_path_misses.get(),
+            window_hard_resets.get(),
+            leaf_splits.get(),
+            leaf_merge_count.load(),
+            bg_sort_count.load(),
+            sorted_leaf_search.load(),
+            get_sort_queue_depth(),
+            get_sort_lag(),
+            leaf_latch_contention.get(),
+        };
+    }
+
 private:
 
     // Tree structure identifiers
@@ -372,61 +1032,303 @@ private:
 
     node_id_t root_id; // root id
     node_id_t head_id; // id of first leaf
-    std::atomic<size_t> numPages{0}; // keep track of current pages
+    // page 0 is reserved for the superblock, so node ids start at 1
+    std::atomic<size_t> numPages{1}; // keep track of current pages
+
+    // On-disk image of the tree's structural state, written to page 0 by
+    // checkpoint() and read back by open(). The checksum (FNV-1a over the
+    // struct with the field zeroed) rejects torn or foreign page-0 content,
+    // in which case open() refuses and the caller rebuilds via init() and
+    // WAL replay.
+    struct Superblock {
+        uint64_t magic;
+        uint64_t num_pages;
+        uint64_t size;
+        node_id_t root_id;
+        node_id_t head_id;
+        uint8_t height;
+        uint8_t pad[7];
+        uint64_t checksum;
+    };
+    static constexpr uint64_t SUPERBLOCK_MAGIC = 0x314545525453414CULL; // "LASTREE1"
+
+    static uint64_t superblock_checksum(Superblock sb) {
+        sb.checksum = 0;
+        const auto *bytes = reinterpret_cast<const uint8_t *>(&sb);
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < sizeof(sb); ++i) {
+            h = (h ^ bytes[i]) * 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // Fast path tracking. Each inserting thread owns a window over the
+    // leaf it is appending to, so partitioned producers all get O(1)
+    // appends instead of thrashing one shared window. A fresh window is
+    // invalid (empty range) and its failure count starts one short of the
+    // threshold, so a thread adopts the first leaf it inserts into.
+    static constexpr size_t MAX_SOFT_FAILS = 3;
+
+    struct FastPathWindow {
+        // Guards this window alone. The owning thread takes just this on
+        // its inserts; splits and merges lock the registry first and then
+        // each window they clamp, so the insert hot path never serializes
+        // on a tree-wide lock.
+        std::mutex m;
+        node_id_t leaf_id = INVALID_NODE_ID;
+        key_type min_key = std::numeric_limits<key_type>::max();
+        key_type max_key = std::numeric_limits<key_type>::min();
+        size_t soft_update_failures = MAX_SOFT_FAILS - 1;
+
+        bool covers(const key_type &key) const {
+            return leaf_id != INVALID_NODE_ID && key >= min_key && key < max_key;
+        }
+
+        void reset() {
+            leaf_id = INVALID_NODE_ID;
+            min_key = std::numeric_limits<key_type>::max();
+            max_key = std::numeric_limits<key_type>::min();
+            soft_update_failures = MAX_SOFT_FAILS - 1;
+        }
+    };
+
+    // Every window handed out, plus the ones whose threads have exited,
+    // ready for reuse — thread churn recycles windows instead of growing
+    // a map with one entry per thread ever seen. Shared with the
+    // per-thread slots so a thread exiting after the tree is gone can
+    // still hand its window back.
+    struct WindowRegistry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<FastPathWindow>> windows;
+        std::vector<FastPathWindow *> free_list;
+    };
+    std::shared_ptr<WindowRegistry> window_registry = std::make_shared<WindowRegistry>();
+
+    // Keys the thread-local slot map below; a heap address can be reused
+    // by a later tree instance, a counter value cannot.
+    inline static std::atomic<uint64_t> next_tree_instance{0};
+    const uint64_t tree_instance = next_tree_instance.fetch_add(1);
+
+    // In-memory sibling index: the leaf chain mirrored as a list in key
+    // order plus a position map, so chain-order traversal and jumps need
+    // no page reads at all — a full chain walk through the buffer pool
+    // used to evict the entire working set. Splits and merges maintain it
+    // in O(1) while they hold structure_mutex; chain_mutex only covers
+    // the container against concurrent snapshots.
+    mutable std::mutex chain_mutex;
+    std::list<node_id_t> leaf_chain_list;
+    std::unordered_map<node_id_t, typename std::list<node_id_t>::iterator> leaf_chain_pos;
+
+    void chain_reset(const std::vector<node_id_t> &ids) {
+        std::lock_guard<std::mutex> lock(chain_mutex);
+        leaf_chain_list.assign(ids.begin(), ids.end());
+        leaf_chain_pos.clear();
+        for (auto it = leaf_chain_list.begin(); it != leaf_chain_list.end(); ++it) {
+            leaf_chain_pos[*it] = it;
+        }
+    }
+
+    void chain_insert_after(node_id_t left, node_id_t id) {
+        std::lock_guard<std::mutex> lock(chain_mutex);
+        auto it = leaf_chain_pos.find(left);
+        if (it == leaf_chain_pos.end()) return;
+        leaf_chain_pos[id] = leaf_chain_list.insert(std::next(it->second), id);
+    }
 
-    // Fast path tracking
-    node_id_t fast_path_leaf_id;
-    key_type fast_path_min_key;
-    key_type fast_path_max_key;
-    size_t soft_update_failures = 0;
-    const size_t MAX_SOFT_FAILS = 3;
+    void chain_erase(node_id_t id) {
+        std::lock_guard<std::mutex> lock(chain_mutex);
+        auto it = leaf_chain_pos.find(id);
+        if (it == leaf_chain_pos.end()) return;
+        leaf_chain_list.erase(it->second);
+        leaf_chain_pos.erase(it);
+    }
+
+    // Serializes structure modifications (leaf splits and the internal
+    // node updates they propagate); plain leaf inserts only take the
+    // leaf's latch.
+    std::mutex structure_mutex;
 
     // Tree metrics
     uint8_t height;
-    size_t size;
-    size_t fast_path_hits = 0;
+    std::atomic<size_t> size;
+    std::atomic<size_t> fast_path_hits = 0;
     std::atomic<size_t> bg_sort_count = 0;
-    size_t sorted_leaf_search = 0;
-
-    // Thread for background sorting of cold nodes
-    std::thread background_sort_thread;
-    mutable std::unordered_map<node_id_t, std::shared_mutex> leaf_rwlocks;
-
-    // cold nodes related
-    std::mutex queue_mutex;
-    mutable std::mutex leaf_lock_map_mutex;
+    std::atomic<size_t> sorted_leaf_search = 0;
+    std::atomic<size_t> leaf_merge_count = 0;
+
+    // Always-on hot-path counters (see get_stats()). Padded so bumping
+    // one from many threads does not bounce the others' cache lines.
+    StatCounter fast_path_misses;
+    StatCounter window_hard_resets;
+    StatCounter leaf_splits;
+    StatCounter leaf_latch_contention;
+
+    // Retired page versions backing snapshot_range(). Write paths call
+    // copy_on_write under the leaf latch before the first mutation; with
+    // no snapshot active that is one relaxed load.
+    mutable SnapshotManager snapshots;
+
+    // Pool of threads for background sorting of cold nodes
+    size_t num_sorter_threads;
+    std::vector<std::thread> sorter_threads;
+
+    // cold nodes related. The queue is ordered by read temperature (number
+    // of point lookups that hit the node while unsorted), so the leaves
+    // readers actually touch get sorted first. Re-prioritization pushes a
+    // fresh entry and stale ones are skipped on pop.
+    mutable std::mutex queue_mutex;
     std::condition_variable cold_nodes_cv;
-    std::queue<node_id_t> cold_nodes_queue;
+    std::priority_queue<std::pair<size_t, node_id_t>> cold_nodes_queue;
     mutable std::mutex cold_node_mutex;
     std::unordered_set<node_id_t> cold_node_set;
     std::atomic<bool> stop_background_thread{false};
 
-    std::shared_mutex& get_leaf_rwlock(node_id_t id) const {
-        std::lock_guard<std::mutex> guard(leaf_lock_map_mutex);
-        auto [it, inserted] = leaf_rwlocks.try_emplace(id);
-        return it->second;
+    // read temperature per unsorted leaf, reset once the leaf is sorted
+    mutable std::mutex temperature_mutex;
+    mutable std::unordered_map<node_id_t, size_t> read_temperature;
+    std::atomic<size_t> cold_nodes_enqueued{0};
+
+    // Hand a node that left the fast path to the sorter pool. Its priority
+    // is the read temperature accumulated while it sat unsorted.
+    void enqueue_cold_node(node_id_t id) {
+        std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
+        if (cold_node_set.insert(id).second) {
+            size_t temp;
+            {
+                std::lock_guard<std::mutex> temp_lock(temperature_mutex);
+                temp = read_temperature[id];
+            }
+            {
+                std::lock_guard<std::mutex> queue_lock(queue_mutex);
+                cold_nodes_queue.push({temp, id});
+            }
+            cold_nodes_enqueued.fetch_add(1);
+            cold_nodes_cv.notify_one();
+        }
+    }
+
+    // Called by get() when a lookup lands on an unsorted leaf. Bumps the
+    // node's read temperature; if the node is already waiting in the cold
+    // queue, push a fresh higher-priority entry (the stale one is skipped
+    // when popped).
+    void note_unsorted_read(node_id_t id) {
+        size_t temp;
+        {
+            std::lock_guard<std::mutex> temp_lock(temperature_mutex);
+            temp = ++read_temperature[id];
+        }
+        bool queued;
+        {
+            std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
+            queued = cold_node_set.contains(id);
+        }
+        if (queued) {
+            {
+                std::lock_guard<std::mutex> queue_lock(queue_mutex);
+                cold_nodes_queue.push({temp, id});
+            }
+            cold_nodes_cv.notify_one();
+        }
     }
 
-    // Check if a key can use the fast path for insertion
-    bool can_use_fast_path(const key_type &key) const {
-        return key >= fast_path_min_key && key < fast_path_max_key;
+    // True if any thread's window currently points at this leaf
+    bool is_fast_path_leaf(node_id_t id) const {
+        std::lock_guard<std::mutex> reg_lock(window_registry->mutex);
+        for (const auto &win: window_registry->windows) {
+            std::lock_guard<std::mutex> wlock(win->m);
+            if (win->leaf_id == id) return true;
+        }
+        return false;
+    }
+
+    // A departed thread's slot hands its window back through the shared
+    // registry; the shared_ptr keeps the registry alive even when the
+    // tree is destroyed before the thread exits.
+    struct WindowSlot {
+        std::shared_ptr<WindowRegistry> registry;
+        FastPathWindow *win = nullptr;
+
+        ~WindowSlot() {
+            if (win == nullptr) return;
+            std::lock_guard<std::mutex> reg_lock(registry->mutex);
+            {
+                std::lock_guard<std::mutex> wlock(win->m);
+                win->reset();
+            }
+            registry->free_list.push_back(win);
+        }
+    };
+
+    // This thread's window for this tree, cached in a thread-local slot:
+    // after a thread's first insert the lookup is one hash probe with no
+    // tree-wide lock taken, so parallel writers stop serializing here.
+    // Callers synchronize on the returned window's own mutex.
+    FastPathWindow &my_window() {
+        thread_local std::unordered_map<uint64_t, WindowSlot> slots;
+        WindowSlot &slot = slots[tree_instance];
+        if (slot.win == nullptr) {
+            std::lock_guard<std::mutex> reg_lock(window_registry->mutex);
+            if (!window_registry->free_list.empty()) {
+                slot.win = window_registry->free_list.back();
+                window_registry->free_list.pop_back();
+            } else {
+                window_registry->windows.push_back(std::make_unique<FastPathWindow>());
+                slot.win = window_registry->windows.back().get();
+            }
+            slot.registry = window_registry;
+        }
+        return *slot.win;
+    }
+
+    // Enqueue a leaf a window just left, unless another thread's window
+    // still points at it (then it is still hot and sorting it would be
+    // wasted work).
+    void maybe_enqueue_cold(node_id_t id) {
+        if (id == INVALID_NODE_ID) return;
+        {
+            std::lock_guard<std::mutex> reg_lock(window_registry->mutex);
+            for (const auto &win: window_registry->windows) {
+                std::lock_guard<std::mutex> wlock(win->m);
+                if (win->leaf_id == id) return;
+            }
+        }
+        enqueue_cold_node(id);
     }
 
     // Insert using the fast path (O(1) insertion for sequential data)
     void insert_fast_path(const Tuple &t, key_type key) {
         BufferPool &buffer_pool = getDatabase().getBufferPool();
 
-        // std::cout << "insert_fast_path get_mut_page for "
-        //           << " PageId= " << fast_path_leaf_id
-        //           << std::endl;
-        std::unique_lock<std::shared_mutex> lock(get_leaf_rwlock(fast_path_leaf_id));
-        PageId fast_pid{filename, fast_path_leaf_id};
+        FastPathWindow &win = my_window();
+        node_id_t target;
+        {
+            std::lock_guard<std::mutex> lock(win.m);
+            target = win.leaf_id;
+        }
+        PageId fast_pid{file_id, target};
         Page &leaf_page = buffer_pool.get_mut_page(fast_pid);
         leaf_t leaf(leaf_page, td, key_index);
 
-        if (leaf.insert(t)) {
+        bool inserted = false;
+        bool window_valid;
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(fast_pid),
+                                       &leaf_latch_contention.value);
+            // Re-check under the leaf latch: a concurrent split clamps
+            // windows that point at the split leaf, and an append past the
+            // clamp would land in a leaf the key no longer belongs to.
+            {
+                std::lock_guard<std::mutex> lock(win.m);
+                window_valid = win.leaf_id == target && win.covers(key);
+            }
+            if (window_valid) {
+                snapshots.copy_on_write(target, leaf_page);
+                inserted = leaf.insert(t);
+                if (inserted) buffer_pool.mark_dirty(fast_pid);
+            }
+        }
+        if (inserted) {
             // different insert impl based on leaf type
-            buffer_pool.mark_dirty(fast_pid);
             buffer_pool.unpin_page(fast_pid);
             fast_path_hits++;
             size++;
@@ -435,79 +1337,438 @@ private:
         // insert failed, still need to unpin old page before moving on
         buffer_pool.unpin_page(fast_pid);
 
-        // If we couldn't insert, we need to split the leaf
-        path_t path;
-        key_type next_leaf_min_key;
-        find_path_to_node(path, key, next_leaf_min_key);
+        if (!window_valid) {
+            // the window shrank under us; re-route through the regular path
+            insert_impl(t);
+            return;
+        }
 
-        insert_into_leaf(fast_pid, t, path, next_leaf_min_key);
+        // If we couldn't insert, we need to split the leaf
+        insert_into_leaf(t);
         size++;
     }
 
     /**
-     * insert tuple into leaf by path (splits required)
+     * insert tuple into a full leaf (splits required)
      */
-    void insert_into_leaf(const PageId &pid, const Tuple &t, const path_t &path, key_type &next_leaf_min_key) {
+    void insert_into_leaf(const Tuple &t) {
         auto &buffer_pool = getDatabase().getBufferPool();
-        // std::cout << "insert_into_leaf get_mut_page for "
-        //           << " PageId= " << pid.page
-        //           << std::endl;
+        // One split at a time: the internal node updates below are not
+        // latched, so concurrent producers must not interleave them. The
+        // descent is redone under the lock because an earlier split may
+        // have moved the key's leaf or changed the path.
+        std::lock_guard<std::mutex> structure_lock(structure_mutex);
+
+        key_type key = std::get<key_type>(t.get_field(key_index));
+        path_t path;
+        key_type next_leaf_min_key;
+        node_id_t leaf_id = find_path_to_node(path, key, next_leaf_min_key);
+
+        PageId pid{file_id, leaf_id};
         Page &page = buffer_pool.get_mut_page(pid);
         leaf_t leaf(page, td, key_index);
 
+        // A split that raced us may have freed space in the target leaf.
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(pid));
+            snapshots.copy_on_write(leaf_id, page);
+            if (leaf.insert(t)) {
+                buffer_pool.mark_dirty(pid);
+                buffer_pool.unpin_page(pid);
+                return;
+            }
+        }
+
         // split
         node_id_t new_leaf_id = numPages.fetch_add(1);
-        PageId new_leaf_pid{filename, new_leaf_id};
-        std::unique_lock<std::shared_mutex> lock2(get_leaf_rwlock(new_leaf_id));
+        PageId new_leaf_pid{file_id, new_leaf_id};
         // std::cout << "insert_into_leaf get_mut_page for "
         //           << " PageId= " << new_leaf_id
         //           << std::endl;
         Page &new_leaf_page = buffer_pool.get_mut_page(new_leaf_pid);
         leaf_t new_leaf(new_leaf_page, td, key_index, new_leaf_id, INVALID_NODE_ID, false);
 
-        key_type split_key = leaf.split_into(new_leaf);
-        buffer_pool.mark_dirty(pid);
-        buffer_pool.mark_dirty(new_leaf_pid);
-
-        // Insert again (must succeed)
-        key_type key = std::get<key_type>(t.get_field(key_index));
-        node_id_t original_fast_path = fast_path_leaf_id;
-        if (key < split_key) {
-            leaf.insert(t);
-            fast_path_leaf_id = leaf.page_header->id;
-            fast_path_min_key = leaf.min_key();
-            fast_path_max_key = split_key - 1;
-        } else {
-            new_leaf.insert(t);
-            fast_path_leaf_id = new_leaf_id;
-            fast_path_min_key = split_key;
+        key_type split_key;
+        node_id_t original_fast_path;
+        node_id_t new_fast_path;
+        {
+            OptimisticWriteGuard old_guard(buffer_pool.page_latch(pid));
+            OptimisticWriteGuard new_guard(buffer_pool.page_latch(new_leaf_pid));
+
+            // Suffix-truncate the published separator: anything in
+            // (left max, right min] routes correctly, and the shortest
+            // such key keeps internal fanout up for wide key types.
+            snapshots.copy_on_write(leaf_id, page);
+            snapshots.note_birth(new_leaf_id, leaf_id);
+            split_key = leaf.split_into(new_leaf);
+            split_key = truncate_separator(leaf.max_key(), split_key);
+            leaf_splits.inc();
+            buffer_pool.mark_dirty(pid);
+            buffer_pool.mark_dirty(new_leaf_pid);
+
+            // Insert again (must succeed)
+            {
+                // Other threads' windows that pointed at the split leaf no
+                // longer cover the upper half; clamp them while we still
+                // hold the leaf latch so no fast path appends past it.
+                {
+                    std::lock_guard<std::mutex> reg_lock(window_registry->mutex);
+                    for (const auto &w: window_registry->windows) {
+                        std::lock_guard<std::mutex> wlock(w->m);
+                        if (w->leaf_id == pid.page && w->max_key >= split_key) {
+                            w->max_key = split_key - 1;
+                        }
+                    }
+                }
 
-            // update fast path to be new leaf
-            node_id_t next_next_id = new_leaf.page_header->meta.next_id;
-            if (next_next_id != INVALID_NODE_ID) {
-                fast_path_max_key = next_leaf_min_key - 1;
+                FastPathWindow &win = my_window();
+                std::lock_guard<std::mutex> lock(win.m);
+                original_fast_path = win.leaf_id;
+                if (key < split_key) {
+                    leaf.insert(t);
+                    win.leaf_id = leaf.page_header->id;
+                    win.min_key = leaf.min_key();
+                    win.max_key = split_key - 1;
+                } else {
+                    new_leaf.insert(t);
+                    win.leaf_id = new_leaf_id;
+                    win.min_key = split_key;
+
+                    // update this window to cover the new leaf
+                    node_id_t next_next_id = new_leaf.page_header->meta.next_id;
+                    if (next_next_id != INVALID_NODE_ID) {
+                        win.max_key = next_leaf_min_key - 1;
+                    } else {
+                        win.max_key = std::numeric_limits<key_type>::max();
+                    }
+                }
+                new_fast_path = win.leaf_id;
             }
         }
         buffer_pool.unpin_page(pid);
         buffer_pool.unpin_page(new_leaf_pid);
+        chain_insert_after(leaf_id, new_leaf_id);
 
         // after fast path update
-        if (original_fast_path != fast_path_leaf_id) {
+        if (original_fast_path != new_fast_path) {
+            maybe_enqueue_cold(original_fast_path);
+        }
+
+        internal_insert(path, split_key, new_leaf_id);
+    }
+
+    /**
+     * Shared core of the two update() overloads: locate the live leaf
+     * owning key, rebuild the replacement tuple from the stored version
+     * under the leaf's write latch, and append it. The latch-free descent
+     * can race structure changes exactly like get() and insert_impl, so
+     * the same recoveries apply: a dead leaf means a merge moved the key
+     * to the left survivor (redo the descent), a key at or past the right
+     * sibling's minimum means a split moved it out (follow the chain).
+     * When the version append finds no room the leaf is compacted in
+     * place, and split if even that is not enough — an update for a
+     * present key must never fail just because the page filled up.
+     *
+     * rewrite is called with the current stored tuple and returns the
+     * replacement; it may run more than once if the attempt is retried.
+     * Returns the tuple actually written, or nullopt if the key is absent.
+     */
+    template<typename Rewrite>
+    std::optional<Tuple> update_core(const key_type &key, Rewrite &&rewrite) {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        path_t path;
+        node_id_t leaf_id = find_leaf(path, key);
+
+        std::optional<Tuple> applied;
+        for (;;) {
+            PageId leaf_pid{file_id, leaf_id};
+            Page &leaf_page = buffer_pool.get_mut_page(leaf_pid);
+            leaf_t leaf(leaf_page, td, key_index);
+
+            // The read-modify-write sits under the write latch like inserts
+            // do: it bumps the frame version so optimistic readers never
+            // validate against a half-written record, and it cannot
+            // interleave with a guarded insert or sort on the same page.
+            node_id_t hop_to = INVALID_NODE_ID;
+            bool restart = false;
+            bool full = false;
             {
-                std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
-                if (cold_node_set.insert(original_fast_path).second) {
-                    std::lock_guard<std::mutex> queue_lock(queue_mutex);
-                    cold_nodes_queue.push(original_fast_path);
-                    // std::cout << "[Thread " << std::this_thread::get_id() << "[BG_QUEUE] Enqueued cold node ID: " << original_fast_path << " (from insert_into_leaf)\n";
-                    cold_nodes_cv.notify_one();
+                OptimisticWriteGuard guard(buffer_pool.page_latch(leaf_pid),
+                                           &leaf_latch_contention.value);
+                if (leaf.page_header->meta.isDead) {
+                    restart = true;
+                } else {
+                    std::optional<Tuple> current = leaf.get(key);
+                    node_id_t next_id = leaf.page_header->meta.next_id;
+                    if (!current.has_value() && next_id != INVALID_NODE_ID &&
+                        key >= sibling_min_key(next_id)) {
+                        // a hit is authoritative — a split never leaves the
+                        // key behind — so the sibling probe only costs
+                        // updates that miss at a fence
+                        hop_to = next_id;
+                    } else if (current.has_value()) {
+                        Tuple replacement = rewrite(*current);
+                        snapshots.copy_on_write(leaf_id, leaf_page);
+                        bool fits = leaf.update(replacement);
+                        if (!fits && !leaf.is_sorted()) {
+                            // compacting drops shadowed versions and
+                            // tombstones, which is usually room enough
+                            leaf.sort();
+                            buffer_pool.mark_dirty(leaf_pid);
+                            fits = leaf.update(replacement);
+                        }
+                        if (fits) {
+                            buffer_pool.mark_dirty(leaf_pid);
+                            applied = std::move(replacement);
+                        } else {
+                            full = true;
+                        }
+                    }
                 }
             }
+            buffer_pool.unpin_page(leaf_pid);
+
+            if (restart) {
+                path.clear();
+                leaf_id = find_leaf(path, key);
+                continue;
+            }
+            if (hop_to != INVALID_NODE_ID) {
+                leaf_id = hop_to;
+                continue;
+            }
+            if (full) {
+                // live records alone fill the page; split it and retry from
+                // a fresh descent
+                split_for_room(key);
+                path.clear();
+                leaf_id = find_leaf(path, key);
+                continue;
+            }
+            break;
         }
+        return applied;
+    }
+
+    /**
+     * Split the leaf a key routes to without inserting anything: the
+     * backstop for update_core when a version append finds no room even
+     * after compaction. Same discipline as insert_into_leaf — one
+     * structure change at a time, descent redone under the lock.
+     */
+    void split_for_room(const key_type &target_key) {
+        auto &buffer_pool = getDatabase().getBufferPool();
+        std::lock_guard<std::mutex> structure_lock(structure_mutex);
+
+        key_type key = target_key;
+        path_t path;
+        key_type next_leaf_min_key;
+        node_id_t leaf_id = find_path_to_node(path, key, next_leaf_min_key);
+
+        PageId pid{file_id, leaf_id};
+        Page &page = buffer_pool.get_mut_page(pid);
+        leaf_t leaf(page, td, key_index);
+
+        // A merge that raced us may have absorbed the leaf; the survivor
+        // the retry descends to has room by the merge threshold.
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(pid));
+            if (leaf.page_header->meta.isDead) {
+                buffer_pool.unpin_page(pid);
+                return;
+            }
+        }
+
+        node_id_t new_leaf_id = numPages.fetch_add(1);
+        PageId new_leaf_pid{file_id, new_leaf_id};
+        Page &new_leaf_page = buffer_pool.get_mut_page(new_leaf_pid);
+        leaf_t new_leaf(new_leaf_page, td, key_index, new_leaf_id, INVALID_NODE_ID, false);
+
+        key_type split_key;
+        {
+            OptimisticWriteGuard old_guard(buffer_pool.page_latch(pid));
+            OptimisticWriteGuard new_guard(buffer_pool.page_latch(new_leaf_pid));
+
+            snapshots.copy_on_write(leaf_id, page);
+            snapshots.note_birth(new_leaf_id, leaf_id);
+            split_key = leaf.split_into(new_leaf);
+            split_key = truncate_separator(leaf.max_key(), split_key);
+            leaf_splits.inc();
+            buffer_pool.mark_dirty(pid);
+            buffer_pool.mark_dirty(new_leaf_pid);
+
+            // Clamp windows that pointed at the split leaf, same as
+            // insert_into_leaf; no window adopts the new leaf because
+            // nothing is being appended here.
+            std::lock_guard<std::mutex> reg_lock(window_registry->mutex);
+            for (const auto &w: window_registry->windows) {
+                std::lock_guard<std::mutex> wlock(w->m);
+                if (w->leaf_id == pid.page && w->max_key >= split_key) {
+                    w->max_key = split_key - 1;
+                }
+            }
+        }
+        buffer_pool.unpin_page(pid);
+        buffer_pool.unpin_page(new_leaf_pid);
+        chain_insert_after(leaf_id, new_leaf_id);
 
         internal_insert(path, split_key, new_leaf_id);
     }
 
-    // Only returns the leaf node id and path to it
+    // Append one redo record for this file and ride the group commit;
+    // no-op while no WAL is enabled (or during replay).
+    void wal_log(WriteAheadLog::RecordType type, const Tuple &t) {
+        WriteAheadLog *wal = getDatabase().getWAL();
+        if (wal == nullptr) return;
+        std::vector<uint8_t> buf(td.length(t));
+        td.serialize(buf.data(), t);
+        wal->commit(wal->append(type, filename, buf.data(), buf.size()));
+    }
+
+    // One record per tuple but a single sync for the whole batch.
+    void wal_log_batch(std::span<const Tuple> tuples) {
+        WriteAheadLog *wal = getDatabase().getWAL();
+        if (wal == nullptr || tuples.empty()) return;
+        uint64_t last = 0;
+        std::vector<uint8_t> buf;
+        for (const Tuple &t: tuples) {
+            buf.resize(td.length(t));
+            td.serialize(buf.data(), t);
+            last = wal->append(WriteAheadLog::RecordType::INSERT, filename,
+                               buf.data(), buf.size());
+        }
+        wal->commit(last);
+    }
+
+    // Leaf-chain walk shared by range() and the parallel_range() workers:
+    // descend to the leaf covering lo, then follow next_id collecting
+    // tuples in [lo, hi], prefetching each next leaf before scanning the
+    // current one.
+    std::vector<Tuple> range_scan(const key_type &lo, const key_type &hi) {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        path_t path;
+        std::vector<Tuple> result;
+
+        node_id_t leaf_id = find_leaf(path, lo);
+        while (leaf_id != INVALID_NODE_ID) {
+            PageId page_id{file_id, leaf_id};
+            Page &page = buffer_pool.get_mut_page(page_id);
+            leaf_t leaf(page, td, key_index);
+            // let the kernel fault the next leaf in while we scan this one
+            node_id_t next_id = leaf.page_header->meta.next_id;
+            if (next_id != INVALID_NODE_ID) {
+                prefetchPages(next_id, 1);
+            }
+            std::vector<Tuple> rangeTuples = leaf.get_range(lo, hi);
+            if (rangeTuples.empty()) {
+                buffer_pool.unpin_page(page_id);
+                return result;
+            }
+            result.insert(result.end(), rangeTuples.begin(), rangeTuples.end());
+
+            buffer_pool.unpin_page(page_id);
+            leaf_id = leaf.page_header->meta.next_id;
+        }
+        return result;
+    }
+
+    // Separator keys from the upper internal levels, clipped to (lo, hi],
+    // at most parts - 1 of them. The separators only cut the key range —
+    // each worker still does its own descent — so a read racing a
+    // structure change is harmless: any sorted cut of [lo, hi] partitions
+    // it correctly. Levels are walked top-down until one yields enough
+    // cuts or the next level is leaves.
+    std::vector<key_type> collect_partition_bounds(const key_type &lo, const key_type &hi,
+                                                   size_t parts) const {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        std::vector<key_type> bounds;
+        std::vector<node_id_t> level{root_id};
+
+        while (!level.empty()) {
+            std::vector<key_type> level_bounds;
+            std::vector<node_id_t> next;
+            bool internal = true;
+            for (node_id_t id: level) {
+                PageId pid{file_id, id};
+                Page &page = buffer_pool.get_mut_page(pid);
+                auto *base = reinterpret_cast<BaseHeader *>(page.data());
+                if (base->type == bp_node_type::LEAF) {
+                    internal = false;
+                    buffer_pool.unpin_page(pid);
+                    break;
+                }
+                internal_t node(page);
+                uint16_t n = node.header->size;
+                for (uint16_t k = 0; k < n; ++k) {
+                    key_type sep = node.keys[k];
+                    if (sep > lo && sep <= hi) {
+                        level_bounds.push_back(sep);
+                    }
+                }
+                for (uint16_t c = 0; c <= n; ++c) {
+                    next.push_back(node.children[c]);
+                }
+                buffer_pool.unpin_page(pid);
+            }
+            // a leaf level offers no separators; keep the level above
+            if (!internal) break;
+            bounds = std::move(level_bounds);
+            if (bounds.size() + 1 >= parts) break;
+            level = std::move(next);
+        }
+
+        // racing rewrites can hand back unordered or duplicate separators;
+        // any sorted unique cut is still a valid partition
+        std::sort(bounds.begin(), bounds.end());
+        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+        // thin out to at most parts - 1 evenly spaced cuts
+        if (bounds.size() > parts - 1) {
+            std::vector<key_type> picked;
+            picked.reserve(parts - 1);
+            for (size_t r = 1; r < parts; ++r) {
+                picked.push_back(bounds[r * bounds.size() / parts]);
+            }
+            picked.erase(std::unique(picked.begin(), picked.end()), picked.end());
+            bounds = std::move(picked);
+        }
+        return bounds;
+    }
+
+    // Fault every internal node into the buffer pool, level by level from
+    // the root, stopping at the leaves. Used by open() so the first
+    // descents after a restart hit warm pages. The deepest internal
+    // level's children are the live leaves in key order, which rebuilds
+    // the sibling index as a side effect without touching a single leaf
+    // page.
+    void warm_internal_levels() {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        std::vector<node_id_t> level{root_id};
+        while (!level.empty()) {
+            std::vector<node_id_t> next;
+            for (node_id_t id: level) {
+                PageId pid{file_id, id};
+                Page &page = buffer_pool.get_mut_page(pid);
+                auto *base = reinterpret_cast<BaseHeader *>(page.data());
+                if (base->type == bp_node_type::LEAF) {
+                    buffer_pool.unpin_page(pid);
+                    chain_reset(level);
+                    return;
+                }
+                internal_t node(page);
+                for (uint16_t i = 0; i <= node.header->size; ++i) {
+                    next.push_back(node.children[i]);
+                }
+                buffer_pool.unpin_page(pid);
+            }
+            level = std::move(next);
+        }
+    }
+
+    // Only returns the leaf node id and path to it. Internal nodes are
+    // read without blocking: each one is validated through its version
+    // latch, and a rewrite racing the read restarts the descent from the
+    // root (trees are shallow, so restarts are cheap and rare).
     node_id_t find_leaf(path_t &path, const key_type &key) {
         auto &buffer_pool = getDatabase().getBufferPool();
         path.reserve(height);
@@ -515,10 +1776,7 @@ private:
         node_id_t node_id = root_id;
 
         while (true) {
-            PageId pid{filename, node_id};
-            // std::cout << "find leaf get_mut_page for "
-            //       << " PageId= " << node_id
-            //       << std::endl;
+            PageId pid{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(pid);
 
             auto *base = reinterpret_cast<BaseHeader *>(page.data());
@@ -529,10 +1787,18 @@ private:
             }
 
             internal_t node(page);
-            path.push_back(node_id);
-
+            OptimisticLatch &latch = buffer_pool.page_latch(pid);
+            uint64_t version = latch.read_begin();
             uint16_t slot = node.child_slot(key);
-            node_id = node.children[slot];
+            node_id_t child = node.children[slot];
+            if (!latch.read_validate(version)) {
+                buffer_pool.unpin_page(pid);
+                path.clear();
+                node_id = root_id;
+                continue;
+            }
+            path.push_back(node_id);
+            node_id = child;
             buffer_pool.unpin_page(pid);
         }
 
@@ -549,7 +1815,7 @@ private:
         node_id_t node_id = root_id;
 
         while (true) {
-            PageId pid{filename, node_id};
+            PageId pid{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(pid);
 
             auto *base = reinterpret_cast<BaseHeader *>(page.data());
@@ -560,30 +1826,68 @@ private:
             }
 
             internal_t node(page);
-            path.push_back(node_id);
-
+            // same latch-free read + version check as find_leaf
+            OptimisticLatch &latch = buffer_pool.page_latch(pid);
+            uint64_t version = latch.read_begin();
             uint16_t slot = node.child_slot(key);
-            node_id = node.children[slot];
-
+            node_id_t child = node.children[slot];
+            key_type fence = leaf_max;
             if (slot < node.header->size) {
-                leaf_max = node.keys[slot];
+                fence = node.keys[slot];
             }
+            if (!latch.read_validate(version)) {
+                buffer_pool.unpin_page(pid);
+                path.clear();
+                node_id = root_id;
+                leaf_max = std::numeric_limits<key_type>::max();
+                continue;
+            }
+            path.push_back(node_id);
+            node_id = child;
+            leaf_max = fence;
             buffer_pool.unpin_page(pid);
         }
         return node_id;
     }
 
+    // Current minimum key of a leaf, read through its version latch without
+    // blocking. Writers use it to recover the true upper fence of the left
+    // sibling: a leaf created by a split starts with its minimum equal to
+    // the split fence, and inserts can never push it below that. Safe to
+    // call while holding the left sibling's write latch — splits and merges
+    // take latches left to right, so the spin always terminates.
+    key_type sibling_min_key(node_id_t id) {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        PageId pid{file_id, id};
+        Page &page = buffer_pool.get_mut_page(pid);
+        leaf_t leaf(page, td, key_index);
+        OptimisticLatch &latch = buffer_pool.page_latch(pid);
+        key_type k;
+        while (true) {
+            uint64_t version = latch.read_begin();
+            k = leaf.min_key();
+            if (latch.read_validate(version)) break;
+        }
+        buffer_pool.unpin_page(pid);
+        return k;
+    }
+
     // Insert a key and child into internal nodes along the path
     void internal_insert(const path_t &path, key_type key, node_id_t child_id) {
         BufferPool &buffer_pool = getDatabase().getBufferPool();
         // Process path in reverse (from leaf's parent up to root)
         for (auto it = path.rbegin(); it != path.rend(); ++it) {
             node_id_t node_id = *it;
-            PageId page_id{filename, node_id};
+            PageId page_id{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(page_id);
             internal_t node(page); // load internal node from buffer
             buffer_pool.mark_dirty(page_id);
 
+            // Internal nodes are read latch-free by descents, so every
+            // rewrite must bump the node's version for them to validate
+            // against.
+            OptimisticWriteGuard node_guard(buffer_pool.page_latch(page_id));
+
             // Find the position where key should be inserted
             uint16_t index = node.child_slot(key);
 
@@ -608,7 +1912,7 @@ private:
             uint16_t original_size = node.header->size;
 
             node_id_t new_node_id = numPages.fetch_add(1);
-            PageId new_page_id{filename, new_node_id};
+            PageId new_page_id{file_id, new_node_id};
             // std::cout << "internal_insert get_mut_page2 for "
             //       << " PageId= " << new_node_id
             //       << std::endl;
@@ -706,7 +2010,7 @@ private:
         BufferPool &buffer_pool = getDatabase().getBufferPool();
 
         // Get current root
-        PageId root_pid{filename, root_id};
+        PageId root_pid{file_id, root_id};
         // std::cout << "create_new_root get_mut_page for "
         //           << " PageId= " << root_id
         //           << std::endl;
@@ -715,7 +2019,7 @@ private:
 
         // Create new left child by copying current root
         node_id_t left_child_id = numPages.fetch_add(1);
-        PageId left_pid{filename, left_child_id};
+        PageId left_pid{file_id, left_child_id};
         // std::cout << "create_new_root get_mut_page2 for "
         //           << " PageId= " << left_child_id
         //           << std::endl;
@@ -732,12 +2036,16 @@ private:
         std::memcpy(left_child.children, old_root.children,
                     (old_root.header->size + 1) * sizeof(node_id_t));
 
-        // Update old root to become a new root
+        // Update old root to become a new root; descents read the root
+        // latch-free, so the rewrite has to bump its version
         buffer_pool.mark_dirty(root_pid);
-        old_root.header->size = 1;
-        old_root.keys[0] = key;
-        old_root.children[0] = left_child_id;
-        old_root.children[1] = right_child_id;
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(root_pid));
+            old_root.header->size = 1;
+            old_root.keys[0] = key;
+            old_root.children[0] = left_child_id;
+            old_root.children[1] = right_child_id;
+        }
 
         // Increase tree height
         height++;
@@ -763,32 +2071,176 @@ private:
                     break;
                 }
 
-                node_id_to_sort = cold_nodes_queue.front();
+                node_id_to_sort = cold_nodes_queue.top().second;
                 cold_nodes_queue.pop();
                 // std::cout << "[BG_WORKER] Dequeued node ID: " << node_id_to_sort << std::endl;
             }
 
+            // Skip stale re-prioritization entries for nodes already sorted
+            {
+                std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
+                if (!cold_node_set.contains(node_id_to_sort)) continue;
+            }
+
             // sort leaf
-            std::unique_lock<std::shared_mutex> leaf_lock(get_leaf_rwlock(node_id_to_sort));
-            PageId pid{filename, node_id_to_sort};
+            PageId pid{file_id, node_id_to_sort};
             // std::cout << "bg_sort get_mut_page for "
             //       << " PageId= " << node_id_to_sort
             //       << std::endl;
             Page &page = buffer_pool.get_mut_page(pid);
-            leaf_t leaf(page, td, key_index);
-            if (!leaf.is_sorted()) {
-                // std::cout << "[BG_WORKER] Sorti ng leaf node ID: " << node_id_to_sort << std::endl;
-                buffer_pool.mark_dirty(pid);
-                leaf.sort();
-                {
-                    std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
-                    cold_node_set.erase(node_id_to_sort);
+            {
+                OptimisticWriteGuard guard(buffer_pool.page_latch(pid));
+                leaf_t leaf(page, td, key_index);
+                if (!leaf.is_sorted()) {
+                    // std::cout << "[BG_WORKER] Sorti ng leaf node ID: " << node_id_to_sort << std::endl;
+                    buffer_pool.mark_dirty(pid);
+                    snapshots.copy_on_write(node_id_to_sort, page);
+                    leaf.sort();
+                    // std::cout << "[Thread " << std::this_thread::get_id() << "[BG_WORKER] Finished sorting node ID: " << node_id_to_sort << std::endl;
                 }
-                // std::cout << "[Thread " << std::this_thread::get_id() << "[BG_WORKER] Finished sorting node ID: " << node_id_to_sort << std::endl;
                 bg_sort_count.fetch_add(1);
             }
             buffer_pool.unpin_page(pid);
+
+            // The node is sorted now either way; its temperature restarts
+            // from zero if it ever goes cold again.
+            {
+                std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
+                cold_node_set.erase(node_id_to_sort);
+            }
+            {
+                std::lock_guard<std::mutex> temp_lock(temperature_mutex);
+                read_temperature.erase(node_id_to_sort);
+            }
+
+            try_merge_with_next(node_id_to_sort);
+        }
+    }
+
+    // Background compaction stage: if a just-sorted leaf sits below the
+    // fill threshold, fold its right sibling into it. sort() already drops
+    // tombstones and shadowed versions; the merge additionally shortens the
+    // leaf chain so scans touch fewer pages. Only siblings hanging off the
+    // same parent are merged — unlinking across a parent boundary would
+    // leave an ancestor separator routing the moved keys into the wrong
+    // subtree. The emptied page is abandoned; there is no free list to
+    // return it to.
+    void try_merge_with_next(node_id_t id) {
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+        // A merge is a structure modification like a split: it rewrites a
+        // parent internal node, so it is serialized the same way.
+        std::lock_guard<std::mutex> structure_lock(structure_mutex);
+
+        PageId pid{file_id, id};
+        Page &page = buffer_pool.get_mut_page(pid);
+        leaf_t leaf(page, td, key_index);
+
+        node_id_t next_id = leaf.page_header->meta.next_id;
+        if (next_id == INVALID_NODE_ID || leaf.get_slot_count() == 0 ||
+            leaf.used_space() * 100 >= leaf_t::available_space * MERGE_THRESHOLD_PERCENT) {
+            buffer_pool.unpin_page(pid);
+            return;
+        }
+
+        // Locate the parent; the sibling must sit directly to our right
+        // under the same internal node.
+        path_t path;
+        find_leaf(path, leaf.min_key());
+        if (path.empty()) {
+            buffer_pool.unpin_page(pid);
+            return;
+        }
+        PageId parent_pid{file_id, path.back()};
+        Page &parent_page = buffer_pool.get_mut_page(parent_pid);
+        internal_t parent(parent_page);
+
+        uint16_t pos = 0;
+        bool adjacent = false;
+        for (uint16_t i = 0; i < parent.header->size; ++i) {
+            if (parent.children[i] == id && parent.children[i + 1] == next_id) {
+                pos = i;
+                adjacent = true;
+                break;
+            }
+        }
+        if (!adjacent) {
+            buffer_pool.unpin_page(parent_pid);
+            buffer_pool.unpin_page(pid);
+            return;
+        }
+
+        PageId next_pid{file_id, next_id};
+        Page &next_page = buffer_pool.get_mut_page(next_pid);
+        leaf_t next(next_page, td, key_index);
+
+        bool merged = false;
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(pid));
+            OptimisticWriteGuard next_guard(buffer_pool.page_latch(next_pid));
+
+            // compact the sibling first so the fit check sees live data only
+            snapshots.copy_on_write(next_id, next_page);
+            if (!next.is_sorted()) {
+                next.sort();
+            }
+            if (leaf.used_space() + next.used_space() <= leaf_t::available_space) {
+                snapshots.copy_on_write(id, page);
+                // every sibling key is larger than ours and both pages are
+                // in slot order, so raw appends keep the layout consistent
+                for (uint16_t s = 0; s < next.get_slot_count(); ++s) {
+                    leaf.append_raw(next.buffer + next.rec_offset(s),
+                                    static_cast<uint16_t>(next.rec_length(s)),
+                                    next.key_at(s));
+                }
+                leaf.page_header->meta.next_id = next.page_header->meta.next_id;
+                // the page keeps its tuples so racing readers still resolve,
+                // but writers that descended here must go back to the root
+                next.page_header->meta.isDead = true;
+                buffer_pool.mark_dirty(pid);
+                buffer_pool.mark_dirty(next_pid);
+                merged = true;
+
+                // windows still pointing at the vanished sibling must stop
+                // appending to it before its latch is released
+                {
+                    std::lock_guard<std::mutex> reg_lock(window_registry->mutex);
+                    for (const auto &win: window_registry->windows) {
+                        std::lock_guard<std::mutex> wlock(win->m);
+                        if (win->leaf_id == next_id) {
+                            win->reset();
+                        }
+                    }
+                }
+            }
+        }
+        buffer_pool.unpin_page(next_pid);
+
+        if (merged) {
+            // drop the separator key and child pointer from the parent,
+            // bumping its version for latch-free descents
+            buffer_pool.mark_dirty(parent_pid);
+            {
+                OptimisticWriteGuard guard(buffer_pool.page_latch(parent_pid));
+                std::memmove(parent.keys + pos, parent.keys + pos + 1,
+                             (parent.header->size - pos - 1) * sizeof(key_type));
+                std::memmove(parent.children + pos + 1, parent.children + pos + 2,
+                             (parent.header->size - pos - 1) * sizeof(node_id_t));
+                --parent.header->size;
+            }
+
+            chain_erase(next_id);
+            {
+                std::lock_guard<std::mutex> cold_node_set_lock(cold_node_mutex);
+                cold_node_set.erase(next_id);
+            }
+            {
+                std::lock_guard<std::mutex> temp_lock(temperature_mutex);
+                read_temperature.erase(next_id);
+            }
+            leaf_merge_count.fetch_add(1);
         }
+        buffer_pool.unpin_page(parent_pid);
+        buffer_pool.unpin_page(pid);
     }
 
     // Print a node and its children recursively (for debugging)
@@ -798,7 +2250,7 @@ private:
             std::cout << "  ";
         }
 
-        PageId pid{filename, node_id};
+        PageId pid{file_id, node_id};
         Page &page = buffer_pool.get_mut_page(pid);
         uint8_t *raw = page.data();
         auto *base = reinterpret_cast<BaseHeader *>(raw);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include <vector>
 #include <stdexcept>
@@ -95,11 +96,16 @@ public:
         return std::get<key_type>(t.get_field(key_index));
     }
 
+    // Key of slot i decoded straight from the serialized record; avoids
+    // the per-tuple allocations of a full deserialize on search probes.
+    key_type key_at(size_t i) const {
+        return std::get<key_type>(td.read_field(buffer + slots[i].offset, key_index));
+    }
+
     key_type min_key() const {
         for (size_t i = 0; i < page_header->slot_count; ++i) {
             if (slots[i].valid) {
-                Tuple t = td.deserialize(buffer + slots[i].offset);
-                return extract_key(t);
+                return key_at(i);
             }
         }
         throw std::runtime_error("Empty node");
@@ -108,8 +114,7 @@ public:
     key_type max_key() const {
         for (int i = page_header->slot_count - 1; i >= 0; --i) {
             if (slots[i].valid) {
-                Tuple t = td.deserialize(buffer + slots[i].offset);
-                return extract_key(t);
+                return key_at(i);
             }
         }
         throw std::runtime_error("Empty node");
@@ -122,13 +127,11 @@ public:
         uint16_t left = 0, right = page_header->slot_count;
         while (left < right) {
             uint16_t mid = (left + right) / 2;
-            Slot cur = slots[mid];
             if (!slots[mid].valid) {
                 ++left;
                 continue;
             }
-            Tuple mid_tuple = td.deserialize(buffer + slots[mid].offset);
-            if (extract_key(mid_tuple) < key) left = mid + 1;
+            if (key_at(mid) < key) left = mid + 1;
             else right = mid;
         }
         return left;
@@ -141,9 +144,8 @@ public:
             const Slot &slot = slots[index];
             if (!slot.valid) return std::nullopt;
 
-            Tuple t = td.deserialize(buffer + slot.offset);
-            if (extract_key(t) == key) {
-                return t;
+            if (key_at(index) == key) {
+                return td.deserialize(buffer + slot.offset);
             }
         }
         return std::nullopt;
@@ -159,26 +161,26 @@ public:
                 if (!slot.valid) {
                     continue;
                 }
-                Tuple t = td.deserialize(buffer + slot.offset);
+                // check the key before materializing anything
+                key_type k = key_at(i);
                 // sorted data allows early cut
-                if (extract_key(t) < minkey) {
+                if (k < minkey) {
                     continue;
                 }
-                if (extract_key(t) > maxkey) {
+                if (k > maxkey) {
                     return result;
                 }
-                result.push_back(t);
+                result.push_back(td.deserialize(buffer + slot.offset));
             }
         }else { // scan
             for (uint16_t i = 0; i < page_header->slot_count; ++i) {
                 const Slot &slot = slots[i];
                 if (!slot.valid) continue;
 
-                Tuple t = td.deserialize(buffer + slot.offset);
-                key_type k = extract_key(t);
+                key_type k = key_at(i);
                 if (k < minkey) continue;
                 if (k > maxkey) continue;
-                result.push_back(t);
+                result.push_back(td.deserialize(buffer + slot.offset));
             }
         }
         return result;
@@ -262,8 +264,7 @@ public:
         if (index < page_header->slot_count) {
             const Slot &slot = slots[index];
             if (slot.valid) {
-                Tuple existing = td.deserialize(buffer + slot.offset);
-                if (extract_key(existing) == key) {
+                if (key_at(index) == key) {
                     // Overwrite slot: mark old invalid, insert new
                     slots[index].valid = false;
                     --page_header->size;
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace db {
+
+    /**
+     * @brief Word-sized versioned latch for optimistic lock coupling.
+     *
+     * The low bit is the write lock, the remaining bits a version counter,
+     * so an even word means "unlocked". Readers take no lock at all:
+     * read_begin() spins until the word is even and returns it, the reader
+     * then works on the page and calls read_validate() — if the version
+     * moved a writer intervened and the reader retries. Writers serialize
+     * on the low bit and bump the version on release.
+     */
+    class OptimisticLatch {
+        std::atomic<uint64_t> word{0};
+
+    public:
+        // Wait out any writer, return the version to validate against.
+        uint64_t read_begin() const {
+            uint64_t v = word.load(std::memory_order_acquire);
+            while (v & 1) {
+                v = word.load(std::memory_order_acquire);
+            }
+            return v;
+        }
+
+        // True iff no writer ran since read_begin() returned v.
+        bool read_validate(uint64_t v) const {
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return word.load(std::memory_order_relaxed) == v;
+        }
+
+        // Returns true when another writer was in the way (lock bit held or
+        // a lost CAS race), so callers can count contention without clocks.
+        bool write_lock() {
+            uint64_t v = word.load(std::memory_order_relaxed);
+            bool contended = false;
+            for (;;) {
+                if (v & 1) {
+                    contended = true;
+                    v = word.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (word.compare_exchange_weak(v, v + 1, std::memory_order_acquire,
+                                               std::memory_order_relaxed)) {
+                    return contended;
+                }
+                contended = true;
+            }
+        }
+
+        void write_unlock() {
+            // +1 clears the lock bit and leaves the version one step ahead,
+            // which is what invalidates concurrent optimistic readers.
+            word.fetch_add(1, std::memory_order_release);
+        }
+    };
+
+    // RAII writer guard over an OptimisticLatch, analogous to
+    // std::unique_lock. The caller must keep the owning frame pinned for
+    // the guard's lifetime. An optional contention counter is bumped when
+    // acquisition had to wait out another writer.
+    class OptimisticWriteGuard {
+        OptimisticLatch &latch;
+
+    public:
+        explicit OptimisticWriteGuard(OptimisticLatch &l,
+                                      std::atomic<uint64_t> *contention = nullptr)
+            : latch(l) {
+            if (latch.write_lock() && contention != nullptr) {
+                contention->fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        ~OptimisticWriteGuard() { latch.write_unlock(); }
+
+        OptimisticWriteGuard(const OptimisticWriteGuard &) = delete;
+        OptimisticWriteGuard &operator=(const OptimisticWriteGuard &) = delete;
+    };
+
+} // namespace db
@@ -1,11 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <atomic>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
-#include <shared_mutex>
 #include <iostream>
 #include <unistd.h>
 #include <limits>
@@ -15,6 +16,7 @@
 #include "NodeTypes.hpp"
 #include "Database.hpp"
 #include "InternalNode.hpp"
+#include "TreeScan.hpp"
 #include "Tuple.hpp"
 
 using namespace db;
@@ -38,6 +40,10 @@ public:
     static constexpr uint16_t SPLIT_INTERNAL_POS = internal_t::internal_capacity / 2;
     static constexpr node_id_t INVALID_NODE_ID = std::numeric_limits<node_id_t>::max();
 
+    // Target leaf fill when bulk-loading from sorted input; the headroom
+    // absorbs some appends before the first splits
+    static constexpr size_t BULK_LOAD_FILL_PERCENT = 90;
+
     // Constructor initializes the tree with an empty root
     explicit OptimizedBTree(SplitPolicy policy, size_t key_index = 0,
                             const std::string &name = "", const TupleDesc &td = {})
@@ -56,14 +62,14 @@ public:
 
         // initialize leaf node
         head_id = numPages.fetch_add(1);
-        PageId leaf_pid{filename, head_id};
+        PageId leaf_pid{file_id, head_id};
         leaf_t leaf(buffer_pool.get_mut_page(leaf_pid), td, key_index, head_id, INVALID_NODE_ID, split_policy, false);
         buffer_pool.mark_dirty(leaf_pid);
         buffer_pool.unpin_page(leaf_pid);
 
         // Initialize root node (internal node pointing to the leaf)
         root_id = numPages.fetch_add(1);
-        PageId root_pid{filename, root_id};
+        PageId root_pid{file_id, root_id};
         internal_t root(buffer_pool.get_mut_page(root_pid), root_id);
         buffer_pool.mark_dirty(root_pid);
         root.header->size = 0;
@@ -97,13 +103,17 @@ public:
         path_t path;
         key_type next_leaf_min_key;
         node_id_t leaf_id = find_path_to_node(path, key, next_leaf_min_key);
-        PageId leaf_pid{filename, leaf_id};
-        std::unique_lock<std::shared_mutex> lock(get_leaf_rwlock(leaf_id));
+        PageId leaf_pid{file_id, leaf_id};
         Page &page = buffer_pool.get_mut_page(leaf_pid);
         leaf_t leaf(page, td, key_index);
 
-        if (leaf.insert(tuple)) {
-            buffer_pool.mark_dirty(leaf_pid);
+        bool inserted;
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(leaf_pid));
+            inserted = leaf.insert(tuple);
+            if (inserted) buffer_pool.mark_dirty(leaf_pid);
+        }
+        if (inserted) {
             size++;
             buffer_pool.unpin_page(leaf_pid);
 
@@ -141,6 +151,116 @@ public:
         size++;
     }
 
+    /**
+     * Bulk-load a fresh tree from tuples already sorted by key. Leaves are
+     * written left-to-right at BULK_LOAD_FILL_PERCENT and linked as they
+     * go, then internal levels are packed bottom-up, so none of the
+     * incremental split machinery runs. Only valid on an empty, quiescent
+     * tree; the initial leaf from init() is abandoned.
+     */
+    template<typename InputIt>
+    void bulk_load(InputIt begin, InputIt end) {
+        if (size != 0) {
+            throw std::runtime_error("bulk_load: tree is not empty");
+        }
+        if (begin == end) return;
+        BufferPool &buffer_pool = getDatabase().getBufferPool();
+
+        const size_t target_bytes =
+            leaf_t::available_space * BULK_LOAD_FILL_PERCENT / 100;
+
+        // 1. leaves, left to right, linked as they are produced
+        std::vector<node_id_t> leaf_ids;
+        std::vector<key_type> leaf_first_keys;
+        size_t count = 0;
+        for (InputIt it = begin; it != end;) {
+            node_id_t id = numPages.fetch_add(1);
+            PageId pid{file_id, id};
+            leaf_t leaf(buffer_pool.get_mut_page(pid), td, key_index, id,
+                        INVALID_NODE_ID, split_policy, false);
+            buffer_pool.mark_dirty(pid);
+
+            leaf_first_keys.push_back(std::get<key_type>((*it).get_field(key_index)));
+            while (it != end && leaf.used_space() < target_bytes) {
+                if (!leaf.insert(*it)) break;
+                ++count;
+                ++it;
+            }
+            // appended in key order with no tombstones, so the page is sorted
+            leaf.page_header->meta.isSorted = true;
+            buffer_pool.unpin_page(pid);
+
+            if (!leaf_ids.empty()) {
+                PageId prev_pid{file_id, leaf_ids.back()};
+                leaf_t prev(buffer_pool.get_mut_page(prev_pid), td, key_index);
+                prev.page_header->meta.next_id = id;
+                buffer_pool.mark_dirty(prev_pid);
+                buffer_pool.unpin_page(prev_pid);
+            }
+            leaf_ids.push_back(id);
+        }
+
+        // 2. internal levels, bottom-up; seps[j] separates child j and j+1
+        std::vector<node_id_t> level = leaf_ids;
+        std::vector<key_type> seps(leaf_first_keys.begin() + 1, leaf_first_keys.end());
+        uint8_t new_height = 1;
+        while (level.size() > static_cast<size_t>(internal_t::internal_capacity) + 1) {
+            std::vector<node_id_t> parents;
+            std::vector<key_type> parent_seps;
+            size_t i = 0;
+            while (i < level.size()) {
+                size_t remaining = level.size() - i;
+                size_t take = std::min<size_t>(internal_t::internal_capacity + 1, remaining);
+                if (remaining - take == 1) --take; // never leave a childless node
+
+                node_id_t nid = numPages.fetch_add(1);
+                PageId npid{file_id, nid};
+                internal_t node(buffer_pool.get_mut_page(npid), nid);
+                buffer_pool.mark_dirty(npid);
+                node.header->size = static_cast<uint16_t>(take - 1);
+                for (size_t c = 0; c < take; ++c) {
+                    node.children[c] = level[i + c];
+                }
+                for (size_t k = 0; k + 1 < take; ++k) {
+                    node.keys[k] = seps[i + k];
+                }
+                buffer_pool.unpin_page(npid);
+
+                if (!parents.empty()) {
+                    parent_seps.push_back(seps[i - 1]);
+                }
+                parents.push_back(nid);
+                i += take;
+            }
+            level = std::move(parents);
+            seps = std::move(parent_seps);
+            ++new_height;
+        }
+
+        // 3. the remaining level fits in the existing root page
+        PageId root_pid{file_id, root_id};
+        internal_t root(buffer_pool.get_mut_page(root_pid), root_id);
+        buffer_pool.mark_dirty(root_pid);
+        root.header->size = static_cast<uint16_t>(level.size() - 1);
+        for (size_t c = 0; c < level.size(); ++c) {
+            root.children[c] = level[c];
+        }
+        for (size_t k = 0; k + 1 < level.size(); ++k) {
+            root.keys[k] = seps[k];
+        }
+        buffer_pool.unpin_page(root_pid);
+
+        head_id = leaf_ids.front();
+        height = new_height;
+        size = count;
+
+        // point the fast path at the rightmost leaf for appends
+        fast_path_leaf_id = leaf_ids.back();
+        fast_path_min_key = leaf_first_keys.back();
+        fast_path_max_key = std::numeric_limits<key_type>::max();
+        soft_update_failures = 0;
+    }
+
     std::optional<db::Tuple> get(const field_t &key) override {
         BufferPool &buffer_pool = getDatabase().getBufferPool();
         key_type actual_key = std::get<key_type>(key);
@@ -149,15 +269,24 @@ public:
         key_type __;
         node_id_t leaf_id = find_leaf(_, actual_key);
 
-        PageId pid{filename, leaf_id};
-        std::shared_lock<std::shared_mutex> lock(get_leaf_rwlock(leaf_id));
+        PageId pid{file_id, leaf_id};
         Page &page = buffer_pool.get_mut_page(pid);
-        leaf_t leaf(page, td, key_index);
-
-        if (leaf.is_sorted()) {
+        OptimisticLatch &latch = buffer_pool.page_latch(pid);
+
+        // Optimistic read: validate the frame version afterwards and redo
+        // the lookup if a writer got in between.
+        std::optional<Tuple> opt_tuple;
+        bool sorted;
+        for (;;) {
+            uint64_t version = latch.read_begin();
+            leaf_t leaf(page, td, key_index);
+            sorted = leaf.is_sorted();
+            opt_tuple = leaf.get(actual_key);
+            if (latch.read_validate(version)) break;
+        }
+        if (sorted) {
             ++sorted_leaf_search;
         }
-        std::optional<Tuple> opt_tuple = leaf.get(actual_key);
         buffer_pool.unpin_page(pid);
         return opt_tuple;
     }
@@ -171,21 +300,25 @@ public:
         path_t path;
         node_id_t leaf_id = find_leaf(path, key);
 
-        PageId leaf_pid{filename, leaf_id};
+        PageId leaf_pid{file_id, leaf_id};
         Page &leaf_page = buffer_pool.get_mut_page(leaf_pid);
         leaf_t leaf(leaf_page, td, key_index);
-        buffer_pool.mark_dirty(leaf_pid);
 
-        auto opt = leaf.get(key);
-        if (!opt.has_value()) return false;
-
-        db::Tuple updated = opt.value();
-
-        for (const auto &[idx, val]: updates) {
-            updated.set_field(idx, val);
+        // Rewrite under the leaf's write latch so the frame version bumps
+        // and optimistic readers retry instead of seeing a torn record.
+        bool result = false;
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(leaf_pid));
+            auto opt = leaf.get(key);
+            if (opt.has_value()) {
+                db::Tuple updated = opt.value();
+                for (const auto &[idx, val]: updates) {
+                    updated.set_field(idx, val);
+                }
+                result = leaf.update(updated);
+                if (result) buffer_pool.mark_dirty(leaf_pid);
+            }
         }
-
-        bool result = leaf.update(updated);
         buffer_pool.unpin_page(leaf_pid);
         return result;
     }
@@ -199,7 +332,7 @@ public:
         key_type actual_max_key = std::get<key_type>(max_key);
         node_id_t leaf_id = find_leaf(path, actual_min_key);
         while (leaf_id != INVALID_NODE_ID) {
-            PageId page_id{filename, leaf_id};
+            PageId page_id{file_id, leaf_id};
             Page &page = buffer_pool.get_mut_page(page_id);
             leaf_t leaf(page, td, key_index);
             std::vector<Tuple> rangeTuples = leaf.get_range(actual_min_key, actual_max_key);
@@ -215,6 +348,17 @@ public:
         return result;
     }
 
+    using scan_t = TreeScan<leaf_t, key_type>;
+
+    // Streaming alternative to range(): returns a cursor that pins one
+    // leaf at a time and yields tuples incrementally instead of
+    // materializing the whole result set.
+    scan_t scan(const key_type &min_key, const key_type &max_key) {
+        path_t path;
+        node_id_t leaf_id = find_leaf(path, min_key);
+        return scan_t(file_id, leaf_id, td, key_index, min_key, max_key);
+    }
+
 
     // Check if a key exists in the tree
     bool contains(const key_type &key) const {
@@ -237,7 +381,7 @@ public:
         node_id_t curr_id = head_id;
         while (curr_id != INVALID_NODE_ID) {
             // fetch from buffer pool and construct
-            Page &page = buffer_pool.get_mut_page({filename, curr_id});
+            Page &page = buffer_pool.get_mut_page({file_id, curr_id});
             leaf_t node(page, td, key_index);
 
             if (!show_all_leaf && curr_id != head_id && node.page_header->meta.next_id != INVALID_NODE_ID) {
@@ -302,7 +446,7 @@ public:
         auto &buffer_pool = getDatabase().getBufferPool();
 
         while (curr != INVALID_NODE_ID) {
-            PageId pid = {filename, curr};
+            PageId pid = {file_id, curr};
             Page &page = buffer_pool.get_mut_page(pid);
             leaf_t leaf(page, td, key_index);
 
@@ -348,15 +492,6 @@ private:
     size_t fast_path_hits = 0;
     size_t sorted_leaf_search = 0;
 
-    mutable std::unordered_map<node_id_t, std::shared_mutex> leaf_rwlocks;
-    mutable std::mutex leaf_lock_map_mutex;
-
-    std::shared_mutex& get_leaf_rwlock(node_id_t id) const {
-        std::lock_guard<std::mutex> guard(leaf_lock_map_mutex);
-        auto [it, inserted] = leaf_rwlocks.try_emplace(id);
-        return it->second;
-    }
-
     // Check if a key can use the fast path for insertion
     bool can_use_fast_path(const key_type &key) const {
         return key >= fast_path_min_key && key < fast_path_max_key;
@@ -365,14 +500,18 @@ private:
     // Insert using the fast path (O(1) insertion for sequential data)
     void insert_fast_path(const Tuple &t, key_type key) {
         BufferPool &buffer_pool = getDatabase().getBufferPool();
-        PageId fast_pid{filename, fast_path_leaf_id};
-        std::unique_lock<std::shared_mutex> lock(get_leaf_rwlock(fast_path_leaf_id));
+        PageId fast_pid{file_id, fast_path_leaf_id};
         Page &leaf_page = buffer_pool.get_mut_page(fast_pid);
         leaf_t leaf(leaf_page, td, key_index);
 
-        if (leaf.insert(t)) {
+        bool inserted;
+        {
+            OptimisticWriteGuard guard(buffer_pool.page_latch(fast_pid));
+            inserted = leaf.insert(t);
+            if (inserted) buffer_pool.mark_dirty(fast_pid);
+        }
+        if (inserted) {
             // different insert impl based on leaf type
-            buffer_pool.mark_dirty(fast_pid);
             buffer_pool.unpin_page(fast_pid);
             fast_path_hits++;
             size++;
@@ -398,31 +537,36 @@ private:
 
         // split
         node_id_t new_leaf_id = numPages.fetch_add(1);
-        PageId new_leaf_pid{filename, new_leaf_id};
-        std::unique_lock<std::shared_mutex> lock2(get_leaf_rwlock(new_leaf_id));
+        PageId new_leaf_pid{file_id, new_leaf_id};
         Page &new_leaf_page = buffer_pool.get_mut_page(new_leaf_pid);
         leaf_t new_leaf(new_leaf_page, td, key_index, new_leaf_id, INVALID_NODE_ID, split_policy, false);
 
-        key_type split_key = leaf.split_into(new_leaf);
-        buffer_pool.mark_dirty(pid);
-        buffer_pool.mark_dirty(new_leaf_pid);
-
-        // Insert again (must succeed)
-        key_type key = std::get<key_type>(t.get_field(key_index));
-        if (key < split_key) {
-            leaf.insert(t);
-            fast_path_leaf_id = leaf.page_header->id;
-            fast_path_min_key = leaf.min_key();
-            fast_path_max_key = split_key - 1;
-        } else {
-            new_leaf.insert(t);
-            fast_path_leaf_id = new_leaf_id;
-            fast_path_min_key = split_key;
-
-            // update fast path to be new leaf
-            node_id_t next_next_id = new_leaf.page_header->meta.next_id;
-            if (next_next_id != INVALID_NODE_ID) {
-                fast_path_max_key = next_leaf_min_key - 1;
+        key_type split_key;
+        {
+            OptimisticWriteGuard old_guard(buffer_pool.page_latch(pid));
+            OptimisticWriteGuard new_guard(buffer_pool.page_latch(new_leaf_pid));
+
+            split_key = leaf.split_into(new_leaf);
+            buffer_pool.mark_dirty(pid);
+            buffer_pool.mark_dirty(new_leaf_pid);
+
+            // Insert again (must succeed)
+            key_type key = std::get<key_type>(t.get_field(key_index));
+            if (key < split_key) {
+                leaf.insert(t);
+                fast_path_leaf_id = leaf.page_header->id;
+                fast_path_min_key = leaf.min_key();
+                fast_path_max_key = split_key - 1;
+            } else {
+                new_leaf.insert(t);
+                fast_path_leaf_id = new_leaf_id;
+                fast_path_min_key = split_key;
+
+                // update fast path to be new leaf
+                node_id_t next_next_id = new_leaf.page_header->meta.next_id;
+                if (next_next_id != INVALID_NODE_ID) {
+                    fast_path_max_key = next_leaf_min_key - 1;
+                }
             }
         }
         buffer_pool.unpin_page(pid);
@@ -439,7 +583,7 @@ private:
         node_id_t node_id = root_id;
 
         while (true) {
-            PageId pid{filename, node_id};
+            PageId pid{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(pid);
 
             auto *base = reinterpret_cast<BaseHeader *>(page.data());
@@ -470,7 +614,7 @@ private:
         node_id_t node_id = root_id;
 
         while (true) {
-            PageId pid{filename, node_id};
+            PageId pid{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(pid);
 
             auto *base = reinterpret_cast<BaseHeader *>(page.data());
@@ -500,7 +644,7 @@ private:
         // Process path in reverse (from leaf's parent up to root)
         for (auto it = path.rbegin(); it != path.rend(); ++it) {
             node_id_t node_id = *it;
-            PageId page_id{filename, node_id};
+            PageId page_id{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(page_id);
             internal_t node(page); // load internal node from buffer
             buffer_pool.mark_dirty(page_id);
@@ -529,7 +673,7 @@ private:
             uint16_t original_size = node.header->size;
 
             node_id_t new_node_id = numPages.fetch_add(1);
-            PageId new_page_id{filename, new_node_id};
+            PageId new_page_id{file_id, new_node_id};
 
             Page &new_page = buffer_pool.get_mut_page(new_page_id);
             internal_t new_node(new_page, new_node_id);
@@ -628,13 +772,13 @@ private:
         BufferPool &buffer_pool = getDatabase().getBufferPool();
 
         // Get current root
-        PageId root_pid{filename, root_id};
+        PageId root_pid{file_id, root_id};
         Page &old_root_page = buffer_pool.get_mut_page(root_pid);
         internal_t old_root(old_root_page);
 
         // Create new left child by copying current root
         node_id_t left_child_id = numPages.fetch_add(1);
-        PageId left_pid{filename, left_child_id};
+        PageId left_pid{file_id, left_child_id};
         Page &left_page = buffer_pool.get_mut_page(left_pid);
         internal_t left_child(left_page, left_child_id);
         buffer_pool.mark_dirty(left_pid);
@@ -668,7 +812,7 @@ private:
             std::cout << "  ";
         }
 
-        PageId pid{filename, node_id};
+        PageId pid{file_id, node_id};
         Page &page = buffer_pool.get_mut_page(pid);
         uint8_t *raw = page.data();
         auto *base = reinterpret_cast<BaseHeader *>(raw);
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optional>
+
+#include "BaseFile.hpp"
+#include "Database.hpp"
+#include "LasTree.hpp"
+#include "Tuple.hpp"
+
+using namespace db;
+
+/**
+ * ShardedLasTree: a BaseFile-compatible façade over N key-range-partitioned
+ * LasTree shards. Each shard is a full LasTree with its own file, background
+ * sorter pool and fast path, so partitioned producers scale past the single
+ * tree's one sorter queue and one buffer pool hot set. Point operations
+ * route by key; range() fans out to the overlapping shards in parallel and
+ * concatenates the per-shard results in shard order. Shard ranges are
+ * disjoint, so the output carries the same ordering guarantee as a single
+ * LasTree scan: key order wherever the leaves have been sorted.
+ *
+ * Shard boundaries are fixed at construction: boundaries[i] is the first
+ * key owned by shard i + 1, so N boundaries make N + 1 shards. The shards
+ * register themselves with the Database in init() under "<name>.shard<i>".
+ */
+template<
+    typename key_type,
+    size_t split_percentage>
+class ShardedLasTree : public BaseFile {
+public:
+    using shard_t = LasTree<key_type, split_percentage>;
+
+    explicit ShardedLasTree(size_t key_index = 0,
+                            const std::string &name = "", const TupleDesc &td = {},
+                            std::vector<key_type> boundaries = {},
+                            size_t sorter_pool_size_per_shard = 2)
+        : BaseFile(name),
+          td(td),
+          key_index(key_index),
+          boundaries(std::move(boundaries)),
+          sorter_pool_size(sorter_pool_size_per_shard) {
+        if (!std::is_sorted(this->boundaries.begin(), this->boundaries.end())) {
+            throw std::logic_error("ShardedLasTree: boundaries must be sorted");
+        }
+    }
+
+    void init() override {
+        Database &database = getDatabase();
+        size_t num_shards = boundaries.size() + 1;
+        for (size_t i = 0; i < num_shards; ++i) {
+            std::string shard_name = filename + ".shard" + std::to_string(i);
+            auto shard = std::make_unique<shard_t>(key_index, shard_name, td,
+                                                   sorter_pool_size);
+            shards.push_back(shard.get());
+            database.add(std::move(shard));
+            shards.back()->init();
+        }
+    }
+
+    // The shards are registered with the Database themselves, so teardown
+    // joins their workers through their own stop_background() hooks.
+
+    void insert(const Tuple &t) override {
+        shard_for(std::get<key_type>(t.get_field(key_index)))->insert(t);
+    }
+
+    // Partition the batch by shard and hand each shard one contiguous
+    // batch, so every shard keeps the per-leaf grouping benefit.
+    void insert_batch(std::span<const Tuple> tuples) override {
+        std::vector<std::vector<Tuple>> per_shard(shards.size());
+        for (const Tuple &t: tuples) {
+            per_shard[shard_index(std::get<key_type>(t.get_field(key_index)))].push_back(t);
+        }
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (!per_shard[i].empty()) {
+                shards[i]->insert_batch(per_shard[i]);
+            }
+        }
+    }
+
+    bool update(const Tuple &t) override {
+        return shard_for(std::get<key_type>(t.get_field(key_index)))->update(t);
+    }
+
+    std::optional<db::Tuple> get(const field_t &key) override {
+        return shard_for(std::get<key_type>(key))->get(key);
+    }
+
+    std::vector<Tuple> range(const field_t &min_key, const field_t &max_key) override {
+        key_type min_k = std::get<key_type>(min_key);
+        key_type max_k = std::get<key_type>(max_key);
+
+        size_t first = shard_index(min_k);
+        size_t last = shard_index(max_k);
+
+        if (first == last) {
+            return shards[first]->range(min_key, max_key);
+        }
+
+        std::vector<std::vector<Tuple>> partial(last - first + 1);
+
+        // fan out: every overlapping shard scans its slice concurrently
+        std::vector<std::thread> workers;
+        workers.reserve(last - first + 1);
+        for (size_t s = first; s <= last; ++s) {
+            workers.emplace_back([&, s] {
+                partial[s - first] = shards[s]->range(min_key, max_key);
+            });
+        }
+        for (std::thread &w: workers) {
+            w.join();
+        }
+
+        // shard ranges are disjoint, so concatenation is the merge
+        std::vector<Tuple> result;
+        size_t total = 0;
+        for (const auto &p: partial) total += p.size();
+        result.reserve(total);
+        for (auto &p: partial) {
+            result.insert(result.end(), p.begin(), p.end());
+        }
+        return result;
+    }
+
+    const TupleDesc &getTupleDesc() const override {
+        return td;
+    }
+
+    size_t get_size() const {
+        size_t total = 0;
+        for (const shard_t *shard: shards) {
+            total += shard->get_size();
+        }
+        return total;
+    }
+
+    size_t num_shards() const {
+        return shards.size();
+    }
+
+    shard_t &shard(size_t i) {
+        return *shards.at(i);
+    }
+
+private:
+    const TupleDesc td;
+    size_t key_index;
+
+    // boundaries[i] is the first key routed to shard i + 1
+    std::vector<key_type> boundaries;
+    size_t sorter_pool_size;
+
+    // owned by the Database; raw pointers stay valid for its lifetime
+    std::vector<shard_t *> shards;
+
+    size_t shard_index(const key_type &key) const {
+        return static_cast<size_t>(
+            std::upper_bound(boundaries.begin(), boundaries.end(), key) -
+            boundaries.begin());
+    }
+
+    shard_t *shard_for(const key_type &key) {
+        return shards[shard_index(key)];
+    }
+};
@@ -5,6 +5,8 @@
 
 
 #include <cstdint>
+#include <cstring>
+#include <atomic>
 #include <vector>
 #include <iostream>
 #include <memory>
@@ -18,6 +20,7 @@
 #include <BaseFile.hpp>
 #include <Database.hpp>
 #include <InternalNode.hpp>
+#include "TreeScan.hpp"
 
 using namespace db;
 
@@ -54,7 +57,7 @@ public:
 
         // Allocate leaf node
         head_id = num_pages.fetch_add(1);
-        PageId leaf_pid{filename, head_id};
+        PageId leaf_pid{file_id, head_id};
         Page &leaf_page = buffer_pool.get_mut_page(leaf_pid);
         leaf_t leaf(leaf_page, td, key_index, head_id, INVALID_NODE_ID, SplitPolicy::SORT, /*isCold=*/false);
         buffer_pool.mark_dirty(leaf_pid);
@@ -62,7 +65,7 @@ public:
 
         // Allocate root node
         root_id = num_pages.fetch_add(1);
-        PageId root_pid{filename, root_id};
+        PageId root_pid{file_id, root_id};
         Page &root_page = buffer_pool.get_mut_page(root_pid);
         internal_t root(root_page, root_id);
         buffer_pool.mark_dirty(root_pid);
@@ -81,7 +84,7 @@ public:
         // std::cout << "inserting " << key << std::endl;
 
         node_id_t leaf_id = find_leaf(path, key);
-        PageId leaf_pid{filename, leaf_id};
+        PageId leaf_pid{file_id, leaf_id};
         Page &leaf_page = buffer_pool.get_mut_page(leaf_pid);
         leaf_t leaf(leaf_page, td, key_index);
 
@@ -103,7 +106,7 @@ public:
         key_type actual_key = std::get<key_type>(key);
         path_t path;
         node_id_t leaf_id = find_leaf(path, actual_key);
-        PageId page_id{filename, leaf_id};
+        PageId page_id{file_id, leaf_id};
         Page &page = buffer_pool.get_mut_page(page_id);
         leaf_t leaf(page, td, key_index);
         if (leaf.is_sorted()) {
@@ -123,7 +126,7 @@ public:
         key_type actual_max_key = std::get<key_type>(max_key);
         node_id_t leaf_id = find_leaf(path, actual_min_key);
         while (leaf_id != INVALID_NODE_ID) {
-            PageId page_id{filename, leaf_id};
+            PageId page_id{file_id, leaf_id};
             Page &page = buffer_pool.get_mut_page(page_id);
             leaf_t leaf(page, td, key_index);
             std::vector<Tuple> rangeTuples = leaf.get_range(actual_min_key, actual_max_key);
@@ -139,6 +142,16 @@ public:
         return result;
     }
 
+    using scan_t = TreeScan<leaf_t, key_type>;
+
+    // Streaming alternative to range(): the cursor pins one leaf at a
+    // time and yields tuples incrementally as it walks the next_id chain.
+    scan_t scan(const key_type &min_key, const key_type &max_key) {
+        path_t path;
+        node_id_t leaf_id = find_leaf(path, min_key);
+        return scan_t(file_id, leaf_id, td, key_index, min_key, max_key);
+    }
+
 
 
     // Get the number of elements in the tree
@@ -160,7 +173,7 @@ public:
         auto &buffer_pool = getDatabase().getBufferPool();
 
         while (curr != INVALID_NODE_ID) {
-            PageId pid{filename, curr};
+            PageId pid{file_id, curr};
             Page &page = buffer_pool.get_mut_page(pid);
             leaf_t leaf(page, td, key_index);
 
@@ -203,7 +216,7 @@ private:
         node_id_t node_id = root_id;
 
         while (true) {
-            PageId pid{filename, node_id};
+            PageId pid{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(pid);
 
             auto *base = reinterpret_cast<BaseHeader *>(page.data());
@@ -233,7 +246,7 @@ private:
 
         // split
         node_id_t new_leaf_id = num_pages.fetch_add(1);
-        PageId new_leaf_pid{filename, new_leaf_id};
+        PageId new_leaf_pid{file_id, new_leaf_id};
         Page &new_leaf_page = buffer_pool.get_mut_page(new_leaf_pid);
         leaf_t new_leaf(new_leaf_page, td, key_index, new_leaf_id, INVALID_NODE_ID, SplitPolicy::SORT, false);
 
@@ -260,7 +273,7 @@ private:
         // Process path in reverse (from leaf's parent up to root)
         for (auto it = path.rbegin(); it != path.rend(); ++it) {
             node_id_t node_id = *it;
-            PageId page_id{filename, node_id};
+            PageId page_id{file_id, node_id};
             Page &page = buffer_pool.get_mut_page(page_id);
             internal_t node(page); // load internal node from buffer
             buffer_pool.mark_dirty(page_id);
@@ -288,7 +301,7 @@ private:
             uint16_t original_size = node.header->size;
 
             node_id_t new_node_id = num_pages.fetch_add(1);
-            PageId new_page_id{filename, new_node_id};
+            PageId new_page_id{file_id, new_node_id};
 
             Page &new_page = buffer_pool.get_mut_page(new_page_id);
             internal_t new_node(new_page, new_node_id);
@@ -381,13 +394,13 @@ private:
         BufferPool &buffer_pool = getDatabase().getBufferPool();
 
         // Get current root
-        PageId root_pid{filename, root_id};
+        PageId root_pid{file_id, root_id};
         Page &old_root_page = buffer_pool.get_mut_page(root_pid);
         internal_t old_root(old_root_page);
 
         // Create new left child by copying current root
         node_id_t left_child_id = num_pages.fetch_add(1);
-        PageId left_pid{filename, left_child_id};
+        PageId left_pid{file_id, left_child_id};
         Page &left_page = buffer_pool.get_mut_page(left_pid);
         internal_t left_child(left_page, left_child_id);
         buffer_pool.mark_dirty(left_pid);
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "Types.hpp"
+
+namespace db {
+
+    /**
+     * @brief Page-granularity multiversioning for snapshot-consistent scans.
+     *
+     * A snapshot pins an epoch; writers copy a page's bytes aside before the
+     * first modification in each epoch window, so a reader holding epoch e
+     * can reconstruct every page exactly as it stood when e began: the
+     * retired copy with the oldest stamp >= e if one exists, otherwise the
+     * live page (which then has not changed since the snapshot). Retired
+     * copies are reclaimed as soon as the oldest active epoch moves past
+     * their stamp, and when no snapshot is active the writer hook is a
+     * single relaxed load.
+     *
+     * The copy is made under the writer's page latch and published before
+     * the first mutating store, which gives readers a latch-free protocol
+     * with no torn pages: read the copy if present; otherwise read the live
+     * page and re-check for a copy afterwards — if one appeared, the live
+     * read may have raced a writer and the copy is used instead, and if none
+     * appeared, no mutation can have started before the live read finished.
+     */
+    class SnapshotManager {
+        struct Version {
+            uint64_t stamp;
+            std::unique_ptr<Page> data;
+        };
+
+        // Bumped when a snapshot begins; writers stamp copies with the
+        // current value, so a copy's stamp names the newest epoch whose
+        // snapshot content it holds.
+        std::atomic<uint64_t> global_epoch{1};
+
+        // Lone hot-path check: writers skip everything below when zero.
+        std::atomic<size_t> active_count{0};
+
+        mutable std::mutex mutex;
+        std::map<uint64_t, size_t> active_epochs; // epoch -> reader count
+        std::unordered_map<uint64_t, std::vector<Version>> versions; // stamps ascending
+        std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>> births; // id -> (epoch, origin id)
+
+    public:
+        uint64_t begin_snapshot() {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t e = global_epoch.fetch_add(1) + 1;
+            ++active_epochs[e];
+            active_count.store(active_count.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_release);
+            return e;
+        }
+
+        void end_snapshot(uint64_t e) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = active_epochs.find(e);
+            if (it != active_epochs.end() && --it->second == 0) {
+                active_epochs.erase(it);
+            }
+            active_count.store(active_count.load(std::memory_order_relaxed) - 1,
+                               std::memory_order_release);
+
+            if (active_epochs.empty()) {
+                versions.clear();
+                births.clear();
+                return;
+            }
+            // A copy stamped s serves readers with epoch <= s only, so once
+            // the oldest active epoch passes s nobody can reach it again.
+            uint64_t oldest = active_epochs.begin()->first;
+            for (auto vit = versions.begin(); vit != versions.end();) {
+                auto &chain = vit->second;
+                size_t drop = 0;
+                while (drop < chain.size() && chain[drop].stamp < oldest) ++drop;
+                chain.erase(chain.begin(), chain.begin() + drop);
+                vit = chain.empty() ? versions.erase(vit) : std::next(vit);
+            }
+            for (auto bit = births.begin(); bit != births.end();) {
+                bit = bit->second.first < oldest ? births.erase(bit) : std::next(bit);
+            }
+        }
+
+        // Writer hook: called under the page's write latch before the first
+        // mutating store. At most one copy per page per epoch window.
+        void copy_on_write(uint64_t id, const Page &live) {
+            if (active_count.load(std::memory_order_acquire) == 0) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (active_epochs.empty()) return;
+            // The epoch must be read under the mutex: begin_snapshot bumps
+            // it there, so a snapshot cannot slip between the read and the
+            // publish below and end up with an epoch above this stamp.
+            uint64_t g = global_epoch.load();
+            auto &chain = versions[id];
+            if (!chain.empty() && chain.back().stamp >= g) return; // this window already copied
+            chain.push_back({g, std::make_unique<Page>(live)});
+        }
+
+        // Record that a split created page `id` out of `origin`, so a
+        // snapshot older than the split can redirect its descent to the
+        // page that covered the key range when the snapshot began.
+        void note_birth(uint64_t id, uint64_t origin) {
+            if (active_count.load(std::memory_order_acquire) == 0) return;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (active_epochs.empty()) return;
+            // Same ordering rule as copy_on_write: epoch read under the
+            // mutex so birth epochs and snapshot epochs are totally ordered.
+            uint64_t g = global_epoch.load();
+            births.emplace(id, std::make_pair(g, origin));
+        }
+
+        // Snapshot-visible bytes of the page, or nullptr when the live page
+        // is the snapshot content. Valid until end_snapshot(e): reclamation
+        // only drops copies below the oldest active epoch.
+        Page *read(uint64_t id, uint64_t e) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = versions.find(id);
+            if (it == versions.end()) return nullptr;
+            for (const Version &v: it->second) {
+                if (v.stamp >= e) return v.data.get();
+            }
+            return nullptr;
+        }
+
+        // Where a descent landing on a page born after epoch e should go
+        // instead: the page it was split out of. Applied repeatedly until
+        // the descent reaches a page that existed when e began.
+        std::optional<uint64_t> origin_of(uint64_t id, uint64_t e) const {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = births.find(id);
+            if (it != births.end() && it->second.first >= e) {
+                return it->second.second;
+            }
+            return std::nullopt;
+        }
+
+        // RAII epoch pin for one scan.
+        class Guard {
+            SnapshotManager &mgr;
+            uint64_t e;
+
+        public:
+            explicit Guard(SnapshotManager &mgr) : mgr(mgr), e(mgr.begin_snapshot()) {}
+            ~Guard() { mgr.end_snapshot(e); }
+            Guard(const Guard &) = delete;
+            Guard &operator=(const Guard &) = delete;
+
+            uint64_t epoch() const { return e; }
+        };
+    };
+
+} // namespace db
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace db {
+
+    /**
+     * @brief Cache-line padded relaxed counter for always-on statistics.
+     *
+     * Increments are single relaxed fetch_adds and the padding keeps two
+     * counters from sharing a line, so sprinkling these on hot paths costs
+     * a few cycles, not a coherence storm. Reads are snapshots with no
+     * ordering guarantees — fine for monitoring, not for synchronization.
+     */
+    struct alignas(64) StatCounter {
+        std::atomic<uint64_t> value{0};
+
+        void inc(uint64_t n = 1) {
+            value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        uint64_t get() const {
+            return value.load(std::memory_order_relaxed);
+        }
+    };
+
+} // namespace db
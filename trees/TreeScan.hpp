@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "Database.hpp"
+#include "Tuple.hpp"
+#include "Types.hpp"
+
+namespace db {
+
+    /**
+     * @brief Streaming cursor over a leaf chain for range scans.
+     *
+     * Unlike range(), which materializes every matching tuple up front,
+     * the cursor buffers at most one leaf's worth of results: each refill
+     * pins the current leaf, copies out the tuples in [min_key, max_key],
+     * records next_id and unpins before returning. No page stays pinned
+     * between next() calls, so an abandoned cursor leaks nothing.
+     *
+     * next() yields tuples until the range is exhausted; begin()/end()
+     * expose the same stream as an input iterator for range-for loops.
+     */
+    template<typename leaf_t, typename key_type>
+    class TreeScan {
+        using node_id_t = uint32_t;
+        static constexpr node_id_t INVALID_NODE_ID = std::numeric_limits<node_id_t>::max();
+
+    public:
+        TreeScan(uint32_t file_id, node_id_t start_leaf_id, const TupleDesc &td,
+                 size_t key_index, key_type min_key, key_type max_key)
+            : file_id(file_id),
+              next_leaf_id(start_leaf_id),
+              td(td),
+              key_index(key_index),
+              min_key(min_key),
+              max_key(max_key) {
+        }
+
+        // Returns the next tuple in the range, or nullopt once exhausted.
+        std::optional<Tuple> next() {
+            while (pos >= buffered.size()) {
+                if (done) return std::nullopt;
+                refill();
+            }
+            return std::move(buffered[pos++]);
+        }
+
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = Tuple;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            explicit iterator(TreeScan *s) : scan(s) { advance(); }
+
+            const Tuple &operator*() const { return *current; }
+            const Tuple *operator->() const { return &*current; }
+
+            iterator &operator++() {
+                advance();
+                return *this;
+            }
+
+            void operator++(int) { advance(); }
+
+            bool operator==(const iterator &other) const {
+                return !current.has_value() && !other.current.has_value();
+            }
+
+        private:
+            void advance() {
+                current = scan ? scan->next() : std::nullopt;
+                if (!current.has_value()) scan = nullptr;
+            }
+
+            TreeScan *scan = nullptr;
+            std::optional<Tuple> current;
+        };
+
+        iterator begin() { return iterator(this); }
+        iterator end() { return iterator(); }
+
+    private:
+        // Pin the next leaf, copy out its matching tuples, then unpin and
+        // step the chain. An empty batch means the chain has moved past
+        // max_key (same termination rule as the eager range()).
+        void refill() {
+            buffered.clear();
+            pos = 0;
+            if (next_leaf_id == INVALID_NODE_ID) {
+                done = true;
+                return;
+            }
+            BufferPool &buffer_pool = getDatabase().getBufferPool();
+            PageId pid{file_id, next_leaf_id};
+            Page &page = buffer_pool.get_mut_page(pid);
+            leaf_t leaf(page, td, key_index);
+            buffered = leaf.get_range(min_key, max_key);
+            next_leaf_id = leaf.page_header->meta.next_id;
+            buffer_pool.unpin_page(pid);
+            if (buffered.empty()) done = true;
+        }
+
+        uint32_t file_id;
+        node_id_t next_leaf_id;
+        TupleDesc td;
+        size_t key_index;
+        key_type min_key;
+        key_type max_key;
+
+        std::vector<Tuple> buffered;
+        size_t pos = 0;
+        bool done = false;
+    };
+
+} // namespace db
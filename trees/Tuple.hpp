@@ -4,7 +4,10 @@
 #include <string>
 #include <variant>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
+#include <optional>
+#include <unordered_map>
 
 #include "Types.hpp"
 
@@ -125,6 +128,47 @@ namespace db {
             return types.size();
         }
 
+        /**
+         * @brief Byte offset of a field within a serialized Tuple
+         * @details Only meaningful when every preceding field is fixed width;
+         * returns nullopt if a VARCHAR comes before the field, since the
+         * offset then depends on the actual tuple.
+         * @param i the index of the field
+         * @return the offset in bytes, or nullopt if not fixed
+         */
+        std::optional<size_t> fixed_field_offset(size_t i) const {
+            size_t offset = 0;
+            for (size_t j = 0; j < i; ++j) {
+                switch (types[j]) {
+                    case type_t::INT: offset += INT_SIZE; break;
+                    case type_t::DOUBLE: offset += DOUBLE_SIZE; break;
+                    case type_t::CHAR: offset += CHAR_SIZE; break;
+                    case type_t::VARCHAR: return std::nullopt;
+                }
+            }
+            return offset;
+        }
+
+        /**
+         * @brief Serialized size shared by every tuple of this schema
+         * @details Fixed-width schemas serialize to the same byte count
+         * regardless of the tuple, which lets storage layouts drop
+         * per-record length bookkeeping entirely.
+         * @return the byte count, or nullopt if a VARCHAR makes it vary
+         */
+        std::optional<size_t> fixed_length() const {
+            size_t len = 0;
+            for (type_t t: types) {
+                switch (t) {
+                    case type_t::INT: len += INT_SIZE; break;
+                    case type_t::DOUBLE: len += DOUBLE_SIZE; break;
+                    case type_t::CHAR: len += CHAR_SIZE; break;
+                    case type_t::VARCHAR: return std::nullopt;
+                }
+            }
+            return len;
+        }
+
         /**
          * @brief Get the length of the TupleDesc
          * @return the number of bytes needed to serialize a Tuple with this TupleDesc
@@ -221,6 +265,43 @@ namespace db {
             return {fields, types};
         }
 
+        /**
+         * @brief Decode a single field out of a serialized Tuple
+         * @details Walks the preceding fields (following VARCHAR length
+         * prefixes) and materializes only field i, so hot paths that need
+         * one field — usually the key — skip the two vector allocations a
+         * full deserialize() pays per tuple.
+         * @param data the serialized tuple bytes
+         * @param i the index of the field to decode
+         * @return the decoded field
+         */
+        field_t read_field(const uint8_t *data, size_t i) const {
+            for (size_t j = 0; j < i; ++j) {
+                switch (types[j]) {
+                    case type_t::INT: data += INT_SIZE; break;
+                    case type_t::DOUBLE: data += DOUBLE_SIZE; break;
+                    case type_t::CHAR: data += CHAR_SIZE; break;
+                    case type_t::VARCHAR:
+                        data += sizeof(uint16_t) + *reinterpret_cast<const uint16_t *>(data);
+                    break;
+                }
+            }
+            switch (types[i]) {
+                case type_t::INT:
+                    return *reinterpret_cast<const int *>(data);
+                case type_t::DOUBLE:
+                    return *reinterpret_cast<const double *>(data);
+                case type_t::CHAR:
+                    return std::string(reinterpret_cast<const char *>(data),
+                                       strnlen(reinterpret_cast<const char *>(data), CHAR_SIZE));
+                case type_t::VARCHAR: {
+                    uint16_t len = *reinterpret_cast<const uint16_t *>(data);
+                    return std::string(reinterpret_cast<const char *>(data) + sizeof(uint16_t), len);
+                }
+            }
+            throw std::logic_error("read_field: unknown type");
+        }
+
         /**
          * @brief Merge two TupleDescs
          * @details The merged TupleDesc has all the fields of the two TupleDescs
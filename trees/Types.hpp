@@ -5,6 +5,7 @@
 #include <utility>
 #include <variant>
 #include <cstdint>
+#include <limits>
 #include <iostream>
 
 namespace db {
@@ -18,13 +19,17 @@ namespace db {
 
     using field_t = std::variant<int, double, std::string>;
 
+    // Files are interned to a small integer id at Database::add time, so
+    // PageId stays a POD and hot paths never hash or copy a filename string.
+    constexpr uint32_t INVALID_FILE_ID = std::numeric_limits<uint32_t>::max();
+
     struct PageId {
-        std::string file;
-        size_t page;
+        uint32_t file_id;
+        uint32_t page;
 
     public:
         bool operator==(const PageId& other) const {
-            return file == other.file && page == other.page;
+            return file_id == other.file_id && page == other.page;
         }
     };
 
@@ -48,7 +53,7 @@ namespace std {
     template<>
     struct hash<db::PageId> {
         std::size_t operator()(const db::PageId &r) const {
-            return std::hash<std::string>()(r.file) ^ (std::hash<size_t>()(r.page) << 1);
+            return std::hash<uint64_t>()((static_cast<uint64_t>(r.file_id) << 32) | r.page);
         }
     };
 }
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Types.hpp"
+
+namespace db {
+
+    enum class TraceOp : uint8_t {
+        INSERT = 0,
+        GET = 1,
+        UPDATE = 2,
+    };
+
+    /**
+     * @brief One recorded operation, 24 bytes on disk and in memory.
+     *
+     * Timestamps are nanoseconds since the recorder was created, so the
+     * replayer can reproduce inter-arrival gaps (bursts included) at any
+     * speedup. The originating thread is kept as a small slot id so the
+     * replayer can preserve — or deliberately remap — which operations
+     * raced each other; per-thread order in the file is timestamp order.
+     * Arithmetic keys are stored verbatim, string keys as their hash
+     * (shape-preserving: co-location and skew survive, the bytes do not).
+     */
+    struct TraceRecord {
+        uint64_t ts_ns;
+        int64_t key;
+        uint8_t op;
+        uint8_t thread;
+        uint8_t pad[6];
+    };
+    static_assert(sizeof(TraceRecord) == 24, "trace format is fixed at 24 bytes");
+
+    /**
+     * @brief Captures the shape of live traffic into a compact binary trace.
+     *
+     * Records are buffered under a mutex and written out in batches, so the
+     * per-op cost on the recorded path is a lock and a store — acceptable
+     * for the sampling windows we record in production. Threads get slot
+     * ids in order of first appearance.
+     */
+    class TraceRecorder {
+        int fd;
+        std::chrono::steady_clock::time_point t0;
+        std::mutex mutex;
+        std::vector<TraceRecord> buffer;
+        std::unordered_map<std::thread::id, uint8_t> thread_slots;
+
+        static constexpr size_t FLUSH_RECORDS = 4096;
+
+        void flush_locked() {
+            if (buffer.empty()) return;
+            const uint8_t *bytes = reinterpret_cast<const uint8_t *>(buffer.data());
+            size_t len = buffer.size() * sizeof(TraceRecord);
+            size_t written = 0;
+            while (written < len) {
+                ssize_t n = write(fd, bytes + written, len - written);
+                if (n <= 0) throw std::runtime_error("trace write failed");
+                written += static_cast<size_t>(n);
+            }
+            buffer.clear();
+        }
+
+    public:
+        explicit TraceRecorder(const std::string &path)
+            : t0(std::chrono::steady_clock::now()) {
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                throw std::runtime_error("failed to open trace file: " + path);
+            }
+            buffer.reserve(FLUSH_RECORDS);
+        }
+
+        ~TraceRecorder() {
+            try {
+                flush();
+            } catch (...) {
+            }
+            ::close(fd);
+        }
+
+        void record(TraceOp op, const field_t &key) {
+            int64_t k = std::visit([](const auto &v) -> int64_t {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_arithmetic_v<T>) {
+                    return static_cast<int64_t>(v);
+                } else {
+                    return static_cast<int64_t>(std::hash<T>{}(v));
+                }
+            }, key);
+
+            uint64_t ts = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - t0).count());
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto [it, fresh] = thread_slots.try_emplace(
+                std::this_thread::get_id(),
+                static_cast<uint8_t>(thread_slots.size() & 0xff));
+            (void) fresh;
+            buffer.push_back({ts, k, static_cast<uint8_t>(op), it->second, {}});
+            if (buffer.size() >= FLUSH_RECORDS) {
+                flush_locked();
+            }
+        }
+
+        void flush() {
+            std::lock_guard<std::mutex> lock(mutex);
+            flush_locked();
+        }
+    };
+
+    // Read a whole trace back; truncated tails (recorder killed mid-write)
+    // are dropped silently, like the WAL does.
+    inline std::vector<TraceRecord> load_trace(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("failed to open trace file: " + path);
+        }
+        std::vector<TraceRecord> records;
+        TraceRecord rec;
+        while (true) {
+            ssize_t n = ::read(fd, &rec, sizeof(rec));
+            if (n != static_cast<ssize_t>(sizeof(rec))) break;
+            records.push_back(rec);
+        }
+        ::close(fd);
+        return records;
+    }
+
+} // namespace db
@@ -0,0 +1,204 @@
+#include "WriteAheadLog.hpp"
+#include "Database.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace db {
+
+    namespace {
+        // Sidecar next to the log holding the replay floor: the byte
+        // offset just past the last published CHECKPOINT record. One
+        // sector, rewritten in place; the checksum catches a torn write,
+        // which then just costs a full-log replay.
+        struct CheckpointMark {
+            uint64_t magic;
+            uint64_t offset;
+            uint64_t checksum;
+        };
+        constexpr uint64_t MARK_MAGIC = 0x4b52414d4c4157ULL; // "WALMRK"
+
+        std::string mark_path(const std::string &log_path) {
+            return log_path + ".ckpt";
+        }
+    }
+
+    WriteAheadLog::WriteAheadLog(const std::string &path) : path(path) {
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("WriteAheadLog: failed to open " + path);
+        }
+        struct stat st{};
+        if (fstat(fd, &st) == 0) {
+            next_lsn = static_cast<uint64_t>(st.st_size);
+            durable_lsn = next_lsn;
+        }
+
+        // Pick up the replay floor from the sidecar; anything invalid —
+        // missing file, torn write, a floor past the end of a truncated
+        // log — falls back to replaying from the start, which is safe.
+        int mfd = open(mark_path(path).c_str(), O_RDONLY);
+        if (mfd >= 0) {
+            CheckpointMark mark{};
+            ssize_t n = pread(mfd, &mark, sizeof(mark), 0);
+            if (n == static_cast<ssize_t>(sizeof(mark)) &&
+                mark.magic == MARK_MAGIC &&
+                mark.checksum == (mark.magic ^ mark.offset) &&
+                mark.offset <= next_lsn) {
+                replay_floor = mark.offset;
+            }
+            close(mfd);
+        }
+    }
+
+    WriteAheadLog::~WriteAheadLog() {
+        if (fd >= 0) close(fd);
+    }
+
+    uint64_t WriteAheadLog::append(RecordType type, const std::string &file_name,
+                                   const uint8_t *payload, size_t payload_len) {
+        if (file_name.size() > 255) {
+            throw std::logic_error("WriteAheadLog: file name too long for record header");
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (replaying) return durable_lsn;
+
+        RecordHeader header{};
+        header.payload_len = static_cast<uint32_t>(file_name.size() + payload_len);
+        header.type = static_cast<uint8_t>(type);
+        header.name_len = static_cast<uint8_t>(file_name.size());
+
+        size_t off = buffer.size();
+        buffer.resize(off + sizeof(header) + header.payload_len);
+        std::memcpy(buffer.data() + off, &header, sizeof(header));
+        off += sizeof(header);
+        std::memcpy(buffer.data() + off, file_name.data(), file_name.size());
+        off += file_name.size();
+        if (payload_len > 0) {
+            std::memcpy(buffer.data() + off, payload, payload_len);
+        }
+
+        next_lsn += sizeof(header) + header.payload_len;
+        return next_lsn;
+    }
+
+    void WriteAheadLog::commit(uint64_t lsn) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (durable_lsn < lsn) {
+            if (writer_active) {
+                // a leader is syncing; it (or a later one) covers our lsn
+                cv.wait(lock);
+                continue;
+            }
+            // Become the leader: take everything buffered so far, so every
+            // record appended since the last sync rides this one write.
+            writer_active = true;
+            std::vector<uint8_t> batch;
+            batch.swap(buffer);
+            uint64_t batch_end = next_lsn;
+            lock.unlock();
+
+            size_t written = 0;
+            while (written < batch.size()) {
+                ssize_t n = write(fd, batch.data() + written, batch.size() - written);
+                if (n < 0) {
+                    lock.lock();
+                    writer_active = false;
+                    cv.notify_all();
+                    throw std::runtime_error("WriteAheadLog: write failed for " + path);
+                }
+                written += static_cast<size_t>(n);
+            }
+            fdatasync(fd);
+
+            lock.lock();
+            writer_active = false;
+            durable_lsn = batch_end;
+            cv.notify_all();
+        }
+    }
+
+    uint64_t WriteAheadLog::checkpoint() {
+        // Pages first, then the mark: a mark on disk must never claim pages
+        // that are still only in the pool.
+        getDatabase().getBufferPool().flush_all();
+        uint64_t lsn = append(RecordType::CHECKPOINT, "", nullptr, 0);
+        commit(lsn);
+        return lsn;
+    }
+
+    void WriteAheadLog::publish_checkpoint(uint64_t lsn) {
+        CheckpointMark mark{MARK_MAGIC, lsn, MARK_MAGIC ^ lsn};
+        int mfd = open(mark_path(path).c_str(), O_WRONLY | O_CREAT, 0644);
+        if (mfd < 0) {
+            throw std::runtime_error("WriteAheadLog: failed to open " + mark_path(path));
+        }
+        pwrite(mfd, &mark, sizeof(mark), 0);
+        fdatasync(mfd);
+        close(mfd);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        replay_floor = lsn;
+    }
+
+    size_t WriteAheadLog::replay(Database &db) {
+        uint64_t offset;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            replaying = true;
+            offset = replay_floor;
+        }
+
+        size_t applied = 0;
+        RecordHeader header{};
+        std::vector<uint8_t> record;
+        while (true) {
+            ssize_t n = pread(fd, &header, sizeof(header), offset);
+            if (n < static_cast<ssize_t>(sizeof(header))) break; // end or torn tail
+            record.resize(header.payload_len);
+            n = pread(fd, record.data(), header.payload_len, offset + sizeof(header));
+            if (n < static_cast<ssize_t>(header.payload_len)) break; // torn tail
+            offset += sizeof(header) + header.payload_len;
+
+            auto type = static_cast<RecordType>(header.type);
+            if (type == RecordType::CHECKPOINT) continue;
+            if (header.name_len > header.payload_len) break; // corrupt framing
+
+            std::string name(reinterpret_cast<const char *>(record.data()), header.name_len);
+            BaseFile &file = db.get(name);
+            Tuple t = file.getTupleDesc().deserialize(record.data() + header.name_len);
+            switch (type) {
+                case RecordType::INSERT:
+                    file.insert(t);
+                    break;
+                case RecordType::UPDATE:
+                    // A committed update must re-apply. update() makes its
+                    // own room (compacting or splitting a full leaf), so
+                    // false means the key is gone — losing the record
+                    // silently would hand back pre-update data, so fail
+                    // recovery loudly instead.
+                    if (!file.update(t)) {
+                        {
+                            std::lock_guard<std::mutex> lock(mutex);
+                            replaying = false;
+                        }
+                        throw std::runtime_error(
+                            "WriteAheadLog: UPDATE record did not re-apply to " +
+                            name + " during replay");
+                    }
+                    break;
+                default:
+                    break;
+            }
+            ++applied;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        replaying = false;
+        return applied;
+    }
+
+} // namespace db
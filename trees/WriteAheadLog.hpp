@@ -0,0 +1,96 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace db {
+
+    class Database;
+
+    /**
+     * @brief Sequential redo log with group commit.
+     *
+     * Trees append compact redo records (the serialized tuple plus the
+     * owning file's name) for every mutation and then wait on commit();
+     * durability comes from replaying the log at startup, so the buffer
+     * pool keeps flushing pages lazily off the critical path.
+     *
+     * Commit is leader-based: the first waiter takes everything buffered
+     * so far, writes it and fdatasyncs once, then wakes the rest. Under
+     * concurrent writers one sync covers many records, which is what
+     * keeps per-insert durability at ingest speed.
+     *
+     * Recovery replays the log from the last published checkpoint mark.
+     * checkpoint() flushes all pages and appends a CHECKPOINT record; the
+     * caller publishes that mark as the replay floor once the files'
+     * superblocks are durable too (see Database::checkpointWAL), so
+     * replay cost is bounded by the work since the last checkpoint, not
+     * by the lifetime of the log. The floor lives in a small sidecar
+     * next to the log; a missing or torn sidecar just means replaying
+     * from the start again.
+     */
+    class WriteAheadLog {
+    public:
+        enum class RecordType : uint8_t { INSERT = 0, UPDATE = 1, CHECKPOINT = 2 };
+
+        explicit WriteAheadLog(const std::string &path);
+        ~WriteAheadLog();
+
+        WriteAheadLog(const WriteAheadLog &) = delete;
+        WriteAheadLog &operator=(const WriteAheadLog &) = delete;
+
+        // Buffer one redo record and return its LSN (the byte offset just
+        // past it). The record is not durable until commit(lsn) returns.
+        uint64_t append(RecordType type, const std::string &file_name,
+                        const uint8_t *payload, size_t payload_len);
+
+        // Block until everything up to lsn is on disk. Batch-friendly:
+        // append a run of records and commit only the last LSN.
+        void commit(uint64_t lsn);
+
+        // Flush every dirty page and mark the log. Returns the mark's LSN;
+        // it does not become the replay floor until publish_checkpoint(),
+        // so a crash in between at worst replays records the flushed pages
+        // already cover, never the other way around.
+        uint64_t checkpoint();
+
+        // Persist lsn as the replay floor. Call only once every durable
+        // state the mark claims — flushed pages and the files' superblocks
+        // — is actually on disk.
+        void publish_checkpoint(uint64_t lsn);
+
+        // Re-apply the records past the replay floor to the database's
+        // registered files, in log order. Logging is suppressed while this
+        // runs (replayed mutations are already in the log); call it
+        // single-threaded at startup, after the files are added and
+        // init()'ed or open()'ed. Returns the number of records applied.
+        // A torn tail from a crash mid-append ends the replay cleanly.
+        size_t replay(Database &db);
+
+    private:
+        // On-disk framing; payload_len counts the bytes after the header
+        // (file name, then the serialized tuple).
+        struct RecordHeader {
+            uint32_t payload_len;
+            uint8_t type;
+            uint8_t name_len;
+            uint16_t reserved;
+        };
+
+        int fd;
+        std::string path;
+        uint64_t replay_floor = 0; // byte offset replay starts from
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<uint8_t> buffer; // records appended since the last write
+        uint64_t next_lsn = 0;       // end of the last buffered record
+        uint64_t durable_lsn = 0;    // end of the last synced record
+        bool writer_active = false;  // a leader is writing right now
+        bool replaying = false;      // append/commit are no-ops during replay
+    };
+
+} // namespace db